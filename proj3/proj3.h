@@ -33,6 +33,116 @@ struct cluster_t {
 	/** pointer on array of clusters **/
     struct obj_t *obj;
 };
+
+/**
+ * @brief One step of single-linkage clustering
+ */
+struct merge_t {
+	/** index of first merged cluster at the time of merge **/
+	int idx1;
+	/** index of second merged cluster at the time of merge **/
+	int idx2;
+	/** distance between merged clusters **/
+	float distance;
+};
+
+/**
+ * @brief K-d tree of objects (spatial index)
+ */
+struct kd_index_t {
+	/** points of tree with indexes of their objects **/
+	struct kd_point_t *points;
+	/** nodes of tree, root is the first one **/
+	struct kd_node_t *nodes;
+	/** count of points **/
+	int count;
+};
+
+/**
+ * @brief States of dataset in cache of the server
+ */
+enum dataset_state {
+	/** dataset is being loaded by one request, the others wait **/
+	DATASET_LOADING,
+	/** dataset is loaded and never changed again **/
+	DATASET_READY,
+	/** loading failed, next request tries it again **/
+	DATASET_FAILED,
+};
+
+/**
+ * @brief Dataset kept in memory by the server
+ */
+struct dataset_t {
+	/** name of the input file **/
+	char *filename;
+	/** loaded objects **/
+	struct obj_t *objects;
+	/** count of loaded objects **/
+	int count;
+	/** k-d tree of objects **/
+	struct kd_index_t index;
+	/** complete merge history, count-1 items **/
+	struct merge_t *merges;
+	/** state of loading **/
+	enum dataset_state state;
+	/** next dataset in list of the server **/
+	struct dataset_t *next;
+};
+
+/**
+ * @brief Shared state of the server, guarded by \a lock
+ */
+struct server_t {
+	/** listening socket **/
+	int sock;
+	/** 0 after request "quit" **/
+	int running;
+	/** lock of queue, connections and datasets **/
+	pthread_mutex_t lock;
+	/** signalled on every change of queue, connections and datasets **/
+	pthread_cond_t changed;
+	/** accepted connections waiting for a worker **/
+	int queue[SERVER_QUEUE];
+	/** first waiting connection in \a queue **/
+	int first;
+	/** count of waiting connections **/
+	int queued;
+	/** connections answered by workers, -1 for idle worker **/
+	int active[SERVER_WORKERS];
+	/** list of loaded datasets **/
+	struct dataset_t *datasets;
+};
+
+/**
+ * @brief Edge of spanning tree between two objects
+ */
+struct edge_t {
+	/** index of first object **/
+	int a;
+	/** index of second object **/
+	int b;
+	/** distance between objects **/
+	float distance;
+};
+
+/**
+ * @brief Report of approximate single linkage
+ */
+struct approx_report_t {
+	/** requested tolerance **/
+	float eps;
+	/** separation of pairs of decomposition **/
+	double separation;
+	/** the highest ratio of found and closest possible pair of all searched pairs, at most 1+eps **/
+	double bound;
+	/** count of well-separated pairs **/
+	long pairs;
+	/** count of pairs whose closest pair was searched, the others were dropped **/
+	long searched;
+	/** weight of approximate spanning tree **/
+	double weight;
+};
 /**
  * @}
  */
@@ -186,6 +296,27 @@ void sort_cluster(struct cluster_t *c);
  */
 void print_cluster(struct cluster_t *c);
 
+/**
+ * @brief Printing out cluster into stream \a out.
+ *
+ * @param out Output stream
+ * @param c Cluster with objects
+ */
+void fprint_cluster(FILE *out, struct cluster_t *c);
+
+/**
+ * @brief Loads objects from file into newly allocated array.
+ *
+ * @param filename The input text file with loaded objects
+ * @param arr Objects from the input file, NULL in case of error
+ *
+ * @pre
+ * \a arr is not NULL
+ *
+ * @return Count of loaded objects, 0 for invalid count or allocation error, -1 for file error
+ */
+int load_objects(char *filename, struct obj_t **arr);
+
 /**
  * @brief Loads objects from input text file.
  * For every object creates cluster and saves it into array of clusters.
@@ -217,6 +348,147 @@ int load_clusters(char *filename, struct cluster_t **arr);
  */
 void print_clusters(struct cluster_t *carr, int narr);
 
+/**
+ * @brief Function prints out first \a narr of clusters into stream \a out.
+ *
+ * @param out Output stream
+ * @param carr Pointer on the first item of cluster
+ * @param narr Count of clusters
+ */
+void fprint_clusters(FILE *out, struct cluster_t *carr, int narr);
+
+/**
+ * @brief Copies array of clusters into newly allocated array.
+ *
+ * @param src Array of clusters
+ * @param narr Count of clusters
+ * @return copy of clusters or NULL in case of allocation error
+ */
+struct cluster_t *copy_clusters(struct cluster_t *src, int narr);
+
+/**
+ * @brief Frees all clusters of array and array itself.
+ *
+ * @param carr Array of clusters
+ * @param narr Count of clusters
+ */
+void free_clusters(struct cluster_t *carr, int narr);
+
+/**
+ * @brief Merges clusters down to one cluster and records every merge.
+ *
+ * @pre
+ * \a merges has place for \a narr - 1 items
+ *
+ * @post
+ * Clusters \a carr are unchanged.
+ *
+ * @param carr Array of clusters
+ * @param narr Count of clusters
+ * @param merges Recorded merges in order of merging
+ * @return count of recorded merges or -1 in case of allocation error
+ */
+int build_dendrogram(struct cluster_t *carr, int narr, struct merge_t *merges);
+
+/**
+ * @brief Records complete merge history of dataset from its k-d tree.
+ * Merges are edges of exact minimum spanning tree, merges at equal distance
+ * are ordered as by find_neighbours, so replay gives the same clusters
+ * as build_dendrogram in O(n log n) instead of cubic time.
+ *
+ * @pre
+ * \a ds has loaded objects, k-d tree and place for count - 1 merges
+ *
+ * @param ds Dataset
+ * @return count of recorded merges or -1 in case of allocation error
+ */
+int index_dendrogram(struct dataset_t *ds);
+
+/**
+ * @brief Replays first \a steps merges of dataset by union-find of its objects.
+ *
+ * @param ds Dataset with built dendrogram
+ * @param steps Count of replayed merges
+ * @param arr Resulting array of clusters
+ * @return count of clusters or -1 in case of allocation error
+ */
+int replay_dendrogram(struct dataset_t *ds, int steps, struct cluster_t **arr);
+
+/**
+ * @brief Finds dataset in list of the server, loads it if it is not loaded yet.
+ * Dataset is loaded and its dendrogram built without holding the lock,
+ * other requests for the same dataset wait until it is ready.
+ *
+ * @param server Server
+ * @param filename The input text file
+ * @return dataset or NULL in case of error
+ */
+struct dataset_t *get_dataset(struct server_t *server, char *filename);
+
+/**
+ * @brief Answers one request of the server.
+ * Request is "FILE N" (target count of clusters) or "FILE eps=E"
+ * (clusters closer than or equal to E are merged).
+ *
+ * @param server Server
+ * @param line Request line
+ * @param out Output stream, answer is terminated by empty line
+ */
+void answer_request(struct server_t *server, char *line, FILE *out);
+
+/**
+ * @brief Server mode. Listens on Unix socket, connections are answered
+ * by pool of SERVER_WORKERS threads, every one reads requests of its
+ * connection line by line. Request "quit" stops the server.
+ *
+ * @param path Path of Unix socket
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int serve(char *path);
+
+/**
+ * @brief Approximate minimum spanning tree of objects.
+ * GeoFilterKruskal over well-separated pair decomposition of k-d tree, closest pairs
+ * of pairs are searched lazily with tolerance \a eps. K-d tree is built and decomposed
+ * and closest pairs are searched in parallel with OpenMP.
+ *
+ * @param objects Array of objects
+ * @param count Count of objects
+ * @param eps Tolerance, tree is at most 1+eps times heavier than exact one
+ * @param mst Edges of tree sorted by distance, place for \a count - 1 items
+ * @param report Decomposition and achieved bound
+ * @return count of edges or -1 in case of allocation error
+ */
+int approx_mst(struct obj_t *objects, int count, float eps, struct edge_t *mst, struct approx_report_t *report);
+
+/**
+ * @brief Approximate single linkage, clusters are ordered and sorted as by exact merging.
+ *
+ * @param objects Array of objects
+ * @param count Count of objects
+ * @param n Target count of clusters
+ * @param eps Tolerance of spanning tree
+ * @param arr Resulting array of \a n clusters
+ * @param report Decomposition and achieved bound
+ * @return \a n or -1 in case of allocation error
+ */
+int approx_clusters(struct obj_t *objects, int count, int n, float eps, struct cluster_t **arr, struct approx_report_t *report);
+
+/**
+ * @brief Prints report of approximate single linkage into stream \a out.
+ *
+ * @param out Output stream
+ * @param report Report of approximate single linkage
+ */
+void fprint_report(FILE *out, struct approx_report_t *report);
+
+/**
+ * @brief Benchmark of exact and approximate single linkage on random objects, prints CSV.
+ *
+ * @return EXIT_SUCCESS or EXIT_FAILURE
+ */
+int run_bench(void);
+
 /**
  * @}
  */